@@ -0,0 +1,633 @@
+/*-----------------------------------------------------------------------*/
+/* libbandstream: the STREAM measurement as an in-process API.           */
+/*-----------------------------------------------------------------------*/
+# include <stdarg.h>
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <errno.h>
+# include <fcntl.h>
+# include <unistd.h>
+# include <sys/mman.h>
+# include <sys/resource.h>
+# include "bandstream.h"
+# include "stream_sampler.h"
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
+static const char *placement_names[] = { "malloc", "first-touch", "anon", "tmpfs", "file" };
+# define N_PLACEMENTS	(int)(sizeof(placement_names) / sizeof(placement_names[0]))
+# define POPULATE_SUFFIX	"+populate"
+
+static int32_t roi_lproc_id = 0;
+
+/* Where band_validate() reports for the duration of the call; NULL: silent */
+static FILE *validate_fp = NULL;
+
+static void validate_report(const char *fmt, ...) {
+	if (validate_fp == NULL)
+		return;
+	va_list ap;
+	va_start(ap, fmt);
+	vfprintf(validate_fp, fmt, ap);
+	va_end(ap);
+}
+
+static int checkSTREAMresults(STREAM_TYPE *a, STREAM_TYPE *b, STREAM_TYPE *c,
+                              ssize_t num_elements, int ntimes);
+
+/* --- The STREAM kernels as registry entries --- */
+
+static void copy_body(const KernelContext &ctx, ssize_t lo, ssize_t hi) {
+	ctx.ks->copy(ctx.c+lo, ctx.a+lo, hi-lo);
+}
+
+static void scale_body(const KernelContext &ctx, ssize_t lo, ssize_t hi) {
+	ctx.ks->scale(ctx.b+lo, ctx.c+lo, ctx.scalar, hi-lo);
+}
+
+static void add_body(const KernelContext &ctx, ssize_t lo, ssize_t hi) {
+	ctx.ks->add(ctx.c+lo, ctx.a+lo, ctx.b+lo, hi-lo);
+}
+
+static void triad_body(const KernelContext &ctx, ssize_t lo, ssize_t hi) {
+	ctx.ks->triad(ctx.a+lo, ctx.b+lo, ctx.c+lo, ctx.scalar, hi-lo);
+}
+
+/* The four only check out together: the chain leaves a, b, c as scaled initial a[] */
+static int chain_verify(const KernelContext &ctx, int ntimes) {
+	return checkSTREAMresults(ctx.a, ctx.b, ctx.c, ctx.n, ntimes);
+}
+
+# define STRINGIFY_(x)	#x
+# define STRINGIFY(x)	STRINGIFY_(x)
+
+# define STREAM_KERNEL(name, label, desc, words_read, body, verify) {              \
+	name, label, desc, STRINGIFY(STREAM_TYPE), sizeof(STREAM_TYPE),             \
+	(words_read) * sizeof(STREAM_TYPE), sizeof(STREAM_TYPE), true,             \
+	NULL, body, verify, NULL }
+
+const StreamKernel stream_kernel_copy =
+	STREAM_KERNEL("copy", "Copy", "c = a", 1, copy_body, NULL);
+const StreamKernel stream_kernel_scale =
+	STREAM_KERNEL("scale", "Scale", "b = scalar * c", 1, scale_body, NULL);
+const StreamKernel stream_kernel_add =
+	STREAM_KERNEL("add", "Add", "c = a + b", 2, add_body, NULL);
+const StreamKernel stream_kernel_triad =
+	STREAM_KERNEL("triad", "Triad", "a = b + scalar * c; validates the chain", 2, triad_body, chain_verify);
+
+BandConfig::BandConfig() : num_elements(0), ntimes(10), threads(0), placement(BAND_PLACE_MALLOC),
+	populate(false), align(0), kernels(NULL), params(kernel_params), roi_mode(ROI_LOOP), roi_iteration(-1),
+	exit_after_roi(false) {
+	for (int i = 0; i < 3; i++)
+		offsets[i] = (size_t)i * OFFSET * sizeof(STREAM_TYPE);
+}
+
+static inline STREAM_TYPE nextInitialValue() {
+	return ((STREAM_TYPE)rand()/RAND_MAX)*2.0-1.0;
+}
+
+/* Initial arrays */
+static void initializeArrays(STREAM_TYPE *arr_ptr, uint64_t num_elements) {
+	for (uint64_t i = 0; i < num_elements; i++) {
+		arr_ptr[i] = nextInitialValue();
+	}
+}
+
+/* Threads for the duration of a call; 0 leaves the OpenMP default alone */
+struct ThreadScope {
+	int saved;
+	ThreadScope(int threads) : saved(0) {
+		#ifdef _OPENMP
+		saved = omp_get_max_threads();
+		if (threads > 0)
+			omp_set_num_threads(threads);
+		#else
+		(void)threads;
+		#endif
+	}
+	~ThreadScope() {
+		#ifdef _OPENMP
+		omp_set_num_threads(saved);
+		#endif
+	}
+};
+
+/* kernel_params for the duration of a call */
+struct ParamsScope {
+	KernelParams saved;
+	ParamsScope(const KernelParams &params) : saved(kernel_params) {
+		kernel_params = params;
+	}
+	~ParamsScope() {
+		kernel_params = saved;
+	}
+};
+
+int band_setup(int32_t lproc_id, TimerSource timer) {
+	roi_lproc_id = lproc_id;
+	#if (__amd64__) && (USE_PCM)
+	affinity_set_cpu2(lproc_id);
+	__eco_init(lproc_id);
+	#endif
+	/* Calibrate after pinning so the TSC is read on the ROI core */
+	timer_init(timer);
+	energy_init();
+	/* Opened from the OpenMP team so every worker counts its own cycles */
+	freq_init();
+	return 0;
+}
+
+bool band_parse_placement(const char *name, BandPlacement *p, bool *populate) {
+	std::string s(name);
+	size_t len = strlen(POPULATE_SUFFIX);
+	*populate = s.size() > len && s.compare(s.size() - len, len, POPULATE_SUFFIX) == 0;
+	if (*populate)
+		s.resize(s.size() - len);
+	for (int i = 0; i < N_PLACEMENTS; i++)
+		if (s == placement_names[i]) {
+			*p = (BandPlacement)i;
+			/* malloc memory cannot be populated up front */
+			return !*populate || i >= BAND_PLACE_ANON;
+		}
+	return false;
+}
+
+std::string band_placement_name(BandPlacement p, bool populate) {
+	return std::string(placement_names[p]) + (populate ? POPULATE_SUFFIX : "");
+}
+
+static uint64_t page_faults() {
+	struct rusage ru;
+	getrusage(RUSAGE_SELF, &ru);
+	return ru.ru_minflt + ru.ru_majflt;
+}
+
+/* Directory of the backing files */
+static std::string map_dir(const BandConfig &cfg) {
+	if (cfg.placement == BAND_PLACE_TMPFS)
+		return BAND_TMPFS_DIR;
+	if (!cfg.map_dir.empty())
+		return cfg.map_dir;
+	const char *tmp = getenv("TMPDIR");
+	return tmp != NULL && *tmp != '\0' ? tmp : BAND_FILE_DIR;
+}
+
+/*
+ * 'bytes' of the configured mmap backing; NULL and *err on failure. The
+ * file is unlinked right away, the mapping keeps it alive.
+ */
+static STREAM_TYPE *map_array(const BandConfig &cfg, size_t bytes, std::string *err) {
+	int flags = cfg.populate ? MAP_POPULATE : 0;
+	int fd = -1;
+	void *p;
+	if (cfg.placement == BAND_PLACE_ANON) {
+		flags |= MAP_PRIVATE | MAP_ANONYMOUS;
+	} else {
+		std::string path = map_dir(cfg) + "/band_stream.XXXXXX";
+		fd = mkstemp(&path[0]);
+		if (fd < 0) {
+			*err = "cannot create " + path + ": " + strerror(errno);
+			return NULL;
+		}
+		unlink(path.c_str());
+		if (ftruncate(fd, bytes) != 0) {
+			*err = "cannot size " + path + ": " + strerror(errno);
+			close(fd);
+			return NULL;
+		}
+		flags |= MAP_SHARED;
+	}
+	p = mmap(NULL, bytes, PROT_READ | PROT_WRITE, flags, fd, 0);
+	if (fd >= 0)
+		close(fd);
+	if (p == MAP_FAILED) {
+		*err = std::string("mmap failed: ") + strerror(errno);
+		return NULL;
+	}
+	return (STREAM_TYPE *)p;
+}
+
+/* One store per page, in order, from the calling thread; x need not be page aligned */
+static void touch_pages(STREAM_TYPE *x, size_t bytes) {
+	const size_t page = sysconf(_SC_PAGESIZE);
+	for (size_t off = 0; off < bytes; off += page)
+		((volatile char *)x)[off] = 0;
+	if (bytes > 0)
+		((volatile char *)x)[bytes - 1] = 0;
+}
+
+/* Fault in every page from the thread whose chunk it holds */
+static void first_touch(STREAM_TYPE *x, ssize_t n) {
+	#pragma omp parallel
+	{
+		ssize_t lo, hi;
+		kernel_chunk(n, &lo, &hi);
+		memset(x + lo, 0, (hi - lo) * sizeof(STREAM_TYPE));
+	}
+}
+
+/* Initial contents of a, b, c */
+static void reset_arrays(BandArrays *arr) {
+	srand(INIT_SEED);
+	initializeArrays(arr->a, arr->n);
+	initializeArrays(arr->b, arr->n);
+	initializeArrays(arr->c, arr->n);
+}
+
+int band_alloc(const BandConfig &cfg, BandArrays *arr, std::string *err) {
+	ThreadScope threads(cfg.threads);
+	size_t bytes = cfg.num_elements * sizeof(STREAM_TYPE);
+	const size_t page = sysconf(_SC_PAGESIZE);
+	arr->n = cfg.num_elements;
+	arr->placement = cfg.placement;
+	arr->populate = cfg.populate && cfg.placement >= BAND_PLACE_ANON;
+	arr->align = cfg.align;
+	arr->a = arr->b = arr->c = NULL;
+	arr->kernels.clear();
+	arr->ctx.clear();
+	for (int i = 0; i < 3; i++) {
+		arr->offsets[i] = cfg.offsets[i];
+		arr->base[i] = NULL;
+		arr->map_bytes[i] = 0;
+	}
+	/* What posix_memalign() accepts */
+	if ((cfg.align & (cfg.align - 1)) != 0 || (cfg.align > 0 && cfg.align < sizeof(void *))) {
+		*err = "array alignment " + std::to_string(cfg.align) + " is not a power of two of at least " +
+		       std::to_string(sizeof(void *));
+		return -1;
+	}
+	for (int i = 0; i < 3; i++)
+		if (cfg.offsets[i] % sizeof(STREAM_TYPE) != 0) {
+			*err = "array offsets must be multiples of " + std::to_string(sizeof(STREAM_TYPE)) + " bytes";
+			return -1;
+		}
+
+	/* Timed from the first allocation until every page has been written once */
+	STREAM_TYPE **arrays[3] = { &arr->a, &arr->b, &arr->c };
+	uint64_t faults = page_faults();
+	double t = timer_now();
+	for (int i = 0; i < 3; i++) {
+		size_t len = bytes + cfg.offsets[i];
+		char *p;
+		if (cfg.placement >= BAND_PLACE_ANON) {
+			/* Mappings are page aligned; map the slack for anything coarser */
+			len += cfg.align > page ? cfg.align - page : 0;
+			arr->map_bytes[i] = (len + page - 1) / page * page;
+			if ((arr->base[i] = (char *)map_array(cfg, arr->map_bytes[i], err)) == NULL) {
+				arr->map_bytes[i] = 0;
+				band_free(arr);
+				return -1;
+			}
+		} else {
+			void *m = NULL;
+			if (cfg.align > 0 ? posix_memalign(&m, cfg.align, len) != 0 : (m = malloc(len)) == NULL) {
+				band_free(arr);
+				*err = "cannot allocate three arrays of " + std::to_string(bytes) + " bytes";
+				return -1;
+			}
+			arr->base[i] = (char *)m;
+		}
+		p = arr->base[i];
+		if (cfg.align > 0)
+			p = (char *)(((uintptr_t)p + cfg.align - 1) & ~(uintptr_t)(cfg.align - 1));
+		*arrays[i] = (STREAM_TYPE *)(p + cfg.offsets[i]);
+	}
+	for (int i = 0; i < 3; i++) {
+		if (cfg.placement == BAND_PLACE_FIRST_TOUCH)
+			first_touch(*arrays[i], arr->n);
+		else
+			touch_pages(*arrays[i], bytes);
+	}
+	arr->setup_s = timer_now() - t;
+	arr->setup_faults = page_faults() - faults;
+	reset_arrays(arr);
+
+	for (size_t i = 0; i < registry_size(); i++)
+		if (registry_at(i)->always)
+			arr->kernels.push_back(registry_at(i));
+	for (size_t i = 0; i < cfg.extra.size(); i++)
+		if (!cfg.extra[i]->always)
+			arr->kernels.push_back(cfg.extra[i]);
+	for (size_t i = 0; i < arr->kernels.size(); i++) {
+		const StreamKernel *k = arr->kernels[i];
+		KernelContext ctx;
+		ctx.ks = cfg.kernels != NULL ? cfg.kernels : kernel_set_default();
+		ctx.a = arr->a;
+		ctx.b = arr->b;
+		ctx.c = arr->c;
+		ctx.n = arr->n;
+		ctx.scalar = BAND_SCALAR;
+		ctx.elements = stream_kernel_elements(k, arr->n);
+		ctx.state = NULL;
+		arr->ctx.push_back(ctx);
+		if (k->setup != NULL && k->setup(&arr->ctx.back()) != 0) {
+			band_free(arr);
+			*err = std::string("cannot set up kernel ") + k->name;
+			return -1;
+		}
+	}
+	return 0;
+}
+
+void band_reset(BandArrays *arr) {
+	reset_arrays(arr);
+	for (size_t i = 0; i < arr->kernels.size(); i++)
+		if (arr->kernels[i]->setup != NULL)
+			arr->kernels[i]->setup(&arr->ctx[i]);
+}
+
+void band_free(BandArrays *arr) {
+	for (size_t i = 0; i < arr->ctx.size(); i++)
+		if (arr->kernels[i]->teardown != NULL)
+			arr->kernels[i]->teardown(&arr->ctx[i]);
+	arr->kernels.clear();
+	arr->ctx.clear();
+	for (int i = 0; i < 3; i++) {
+		if (arr->map_bytes[i] > 0)
+			munmap(arr->base[i], arr->map_bytes[i]);
+		else
+			free(arr->base[i]);
+		arr->base[i] = NULL;
+		arr->map_bytes[i] = 0;
+	}
+	arr->a = arr->b = arr->c = NULL;
+}
+
+void band_describe(const BandConfig &cfg, const BandArrays &arr, RunConfig *c) {
+	ThreadScope threads(cfg.threads);
+	result_describe_host(c);
+	c->kernel_variant = (cfg.kernels != NULL ? cfg.kernels : kernel_set_default())->name;
+	c->extra_kernels.clear();
+	for (size_t i = 0; i < cfg.extra.size(); i++)
+		c->extra_kernels.push_back(cfg.extra[i]->name);
+	c->stride = cfg.params.stride;
+	c->prefetch_lines = cfg.params.prefetch_lines;
+	c->placement = band_placement_name(arr.placement, arr.populate);
+	c->setup_s = arr.setup_s;
+	c->setup_faults = arr.setup_faults;
+	c->num_elements = arr.n;
+	c->bytes_per_word = sizeof(STREAM_TYPE);
+	c->ntimes = cfg.ntimes;
+	#ifdef _OPENMP
+	c->threads = omp_get_max_threads();
+	#else
+	c->threads = 1;
+	#endif
+	#if (__amd64__) && (USE_PCM)
+	c->lproc_id = roi_lproc_id;
+	#else
+	c->lproc_id = -1;
+	#endif
+	c->align = arr.align;
+	for (int i = 0; i < 3; i++)
+		c->offsets[i] = arr.offsets[i];
+	c->roi_mode = (cfg.roi_mode == ROI_KERNEL) ? "kernel" : "loop";
+	c->roi_iteration = cfg.roi_iteration;
+}
+
+int band_measure(const BandConfig &cfg, BandArrays *arr, RunResult *res) {
+	ThreadScope threads(cfg.threads);
+	ParamsScope params(cfg.params);
+	/* The team may differ from the one band_setup() opened the counters on */
+	freq_sync();
+	const KernelSet *ks = cfg.kernels != NULL ? cfg.kernels : kernel_set_default();
+	const int nkernels = (int)arr->kernels.size();
+	const int ntimes = cfg.ntimes;
+	const RoiMode roi_mode = cfg.roi_mode;
+	std::vector<std::vector<double> > times(nkernels, std::vector<double>(ntimes));
+	std::vector<std::string> names;
+	int j, k;
+
+	for (j = 0; j < nkernels; j++) {
+		arr->ctx[j].ks = ks;
+		names.push_back(arr->kernels[j]->name);
+	}
+
+	/*	--- MAIN LOOP --- repeat test cases ntimes times --- */
+	ROICounter start(roi_lproc_id); // CRITICAL SECTION : START
+	ROICounter stop(roi_lproc_id);
+	KernelROI kroi(roi_lproc_id, roi_mode, cfg.roi_iteration, names);
+	/* In per-kernel mode the gem5 reset/dump pairs belong to the kernels */
+	if (roi_mode == ROI_LOOP)
+		start.start_roi();
+	else
+		start.mark_roi();
+	for (k=0; k<ntimes; k++) {
+		for (j=0; j<nkernels; j++) {
+			const StreamKernel *kern = arr->kernels[j];
+			const KernelContext &ctx = arr->ctx[j];
+			const size_t traffic = kern->bytes_read + kern->bytes_written;
+
+			kroi.begin(j, k);
+			sampler_phase(j);
+			times[j][k] = timer_now();
+			#pragma omp parallel
+			{
+				ssize_t lo, hi;
+				kernel_chunk(ctx.elements, &lo, &hi);
+				SAMPLED_CHUNK(lo, hi, kern->elem_bytes, traffic, kern->body(ctx, s, s+m))
+			}
+			times[j][k] = timer_now() - times[j][k];
+			sampler_phase(-1);
+			kroi.end(j, k);
+			energy_poll();
+		}
+	}
+	if (roi_mode == ROI_LOOP)
+		stop.stop_roi(); // CRITICAL SECTION : STOP
+	else
+		stop.mark_roi();
+
+	/* Stats are already dumped; skip the host-side report and validation */
+	#ifdef GEM5_RV64
+	if (cfg.exit_after_roi)
+		m5_exit(0);
+	#endif
+
+	/* --- SUMMARY --- */
+	ROICounter diff_count = stop-start;
+
+	*res = RunResult();
+	band_describe(cfg, *arr, &res->config);
+	for (j=0; j<nkernels; j++) {
+		const StreamKernel *kern = arr->kernels[j];
+		KernelResult kr;
+		kr.name = kern->name;
+		kr.bytes = (double)(kern->bytes_read + kern->bytes_written) * arr->ctx[j].elements;
+		kr.times = times[j];
+		kr.roi_samples = kroi.samples[j];
+		kr.roi = kroi.sum[j];
+		res->kernels.push_back(kr);
+	}
+	result_summarize(res);
+	res->roi = diff_count.metrics();
+	res->roi_dumps = kroi.dumps;
+	return 0;
+}
+
+int band_validate(const BandArrays &arr, int ntimes, FILE *report) {
+	int err = 0;
+	validate_fp = report;
+	for (size_t i = 0; i < arr.kernels.size(); i++) {
+		const StreamKernel *k = arr.kernels[i];
+		int failed;
+		if (k->verify == NULL)
+			continue;
+		failed = k->verify(arr.ctx[i], ntimes);
+		err += failed;
+		/* checkSTREAMresults() reports the chain itself */
+		if (!k->always)
+			validate_report("%s %s\n", k->label, failed ? "FAILED validation" : "validates");
+	}
+	validate_fp = NULL;
+	return err;
+}
+
+int band_run(const BandConfig &cfg, RunResult *res, std::string *err, FILE *report) {
+	BandArrays arr;
+	if (band_alloc(cfg, &arr, err) != 0)
+		return -1;
+	band_measure(cfg, &arr, res);
+	res->validation_errors = band_validate(arr, cfg.ntimes, report);
+	band_free(&arr);
+	return 0;
+}
+
+# define	M	20
+
+
+#ifndef abs
+#define abs(a) ((a) >= 0 ? (a) : -(a))
+#endif
+static int checkSTREAMresults(STREAM_TYPE *a, \
+                        STREAM_TYPE *b, \
+						STREAM_TYPE *c, \
+						ssize_t num_elements,
+						int ntimes) {
+	STREAM_TYPE aj,bj,cj,scalar,a0;
+	STREAM_TYPE aSumErr,bSumErr,cSumErr;
+	STREAM_TYPE aAvgErr,bAvgErr,cAvgErr;
+	double epsilon;
+	ssize_t	j;
+	int	k,ierr,err;
+
+    /* reproduce initialization */
+	/* The arrays start out random, but every iteration only depends on
+	 * the previous a[]: aj, bj and cj are the factors each element of the
+	 * initial a[] (replayed from INIT_SEED) is scaled by. */
+	aj = 1.0;
+	bj = 0.0;
+	cj = 0.0;
+    
+	/* now execute timing loop */
+	scalar = 3.0;
+	for (k=0; k<ntimes; k++) {
+        cj = aj;
+        bj = scalar*cj;
+        cj = aj+bj;
+        aj = bj+scalar*cj;
+    }
+
+    /* accumulate deltas between observed and expected results */
+	aSumErr = 0.0;
+	bSumErr = 0.0;
+	cSumErr = 0.0;
+	srand(INIT_SEED);
+	for (j=0; j<num_elements; j++) {
+		a0 = nextInitialValue();
+		aSumErr += abs(a[j] - a0*aj);
+		bSumErr += abs(b[j] - a0*bj);
+		cSumErr += abs(c[j] - a0*cj);
+		// if (j == 417) printf("Index 417: c[j]: %f, cj: %f\n",c[j],cj);	// MCCALPIN
+	}
+	aAvgErr = aSumErr / (STREAM_TYPE) num_elements;
+	bAvgErr = bSumErr / (STREAM_TYPE) num_elements;
+	cAvgErr = cSumErr / (STREAM_TYPE) num_elements;
+
+	if (sizeof(STREAM_TYPE) == 4) {
+		epsilon = 1.e-6;
+	}
+	else if (sizeof(STREAM_TYPE) == 8) {
+		epsilon = 1.e-13;
+	}
+	else {
+		validate_report("WEIRD: sizeof(STREAM_TYPE) = %lu\n",sizeof(STREAM_TYPE));
+		epsilon = 1.e-6;
+	}
+
+	err = 0;
+	if (abs(aAvgErr/aj) > epsilon) {
+		err++;
+		validate_report("Failed Validation on array a[], AvgRelAbsErr > epsilon (%e)\n",epsilon);
+		validate_report("     Expected Value: %e, AvgAbsErr: %e, AvgRelAbsErr: %e\n",aj,aAvgErr,abs(aAvgErr)/aj);
+		ierr = 0;
+		srand(INIT_SEED);
+		for (j=0; j<num_elements; j++) {
+			a0 = nextInitialValue();
+			if (abs(a[j]/aj-a0) > epsilon) {
+				ierr++;
+#ifdef VERBOSE
+				if (ierr < 10) {
+					validate_report("         array a: index: %ld, expected: %e, observed: %e, relative error: %e\n",
+						j,a0*aj,a[j],abs((a0*aj-a[j])/aAvgErr));
+				}
+#endif
+			}
+		}
+		validate_report("     For array a[], %d errors were found.\n",ierr);
+	}
+	if (abs(bAvgErr/bj) > epsilon) {
+		err++;
+		validate_report("Failed Validation on array b[], AvgRelAbsErr > epsilon (%e)\n",epsilon);
+		validate_report("     Expected Value: %e, AvgAbsErr: %e, AvgRelAbsErr: %e\n",bj,bAvgErr,abs(bAvgErr)/bj);
+		validate_report("     AvgRelAbsErr > Epsilon (%e)\n",epsilon);
+		ierr = 0;
+		srand(INIT_SEED);
+		for (j=0; j<num_elements; j++) {
+			a0 = nextInitialValue();
+			if (abs(b[j]/bj-a0) > epsilon) {
+				ierr++;
+#ifdef VERBOSE
+				if (ierr < 10) {
+					validate_report("         array b: index: %ld, expected: %e, observed: %e, relative error: %e\n",
+						j,a0*bj,b[j],abs((a0*bj-b[j])/bAvgErr));
+				}
+#endif
+			}
+		}
+		validate_report("     For array b[], %d errors were found.\n",ierr);
+	}
+	if (abs(cAvgErr/cj) > epsilon) {
+		err++;
+		validate_report("Failed Validation on array c[], AvgRelAbsErr > epsilon (%e)\n",epsilon);
+		validate_report("     Expected Value: %e, AvgAbsErr: %e, AvgRelAbsErr: %e\n",cj,cAvgErr,abs(cAvgErr)/cj);
+		validate_report("     AvgRelAbsErr > Epsilon (%e)\n",epsilon);
+		ierr = 0;
+		srand(INIT_SEED);
+		for (j=0; j<num_elements; j++) {
+			a0 = nextInitialValue();
+			if (abs(c[j]/cj-a0) > epsilon) {
+				ierr++;
+#ifdef VERBOSE
+				if (ierr < 10) {
+					validate_report("         array c: index: %ld, expected: %e, observed: %e, relative error: %e\n",
+						j,a0*cj,c[j],abs((a0*cj-c[j])/cAvgErr));
+				}
+#endif
+			}
+		}
+		validate_report("     For array c[], %d errors were found.\n",ierr);
+	}
+	if (err == 0) {
+		validate_report("Solution Validates: avg error less than %e on all three arrays\n",epsilon);
+	}
+#ifdef VERBOSE
+	validate_report("Results Validation Verbose Results: \n");
+	validate_report("    Expected a(1), b(1), c(1): %f %f %f (times initial a(1))\n",aj,bj,cj);
+	validate_report("    Observed a(1), b(1), c(1): %f %f %f \n",a[1],b[1],c[1]);
+	validate_report("    Rel Errors on a, b, c:     %e %e %e \n",abs(aAvgErr/aj),abs(bAvgErr/bj),abs(cAvgErr/cj));
+#endif
+	return err;
+}
\ No newline at end of file
@@ -0,0 +1,157 @@
+/*-----------------------------------------------------------------------*/
+/* libbandstream: the STREAM measurement as an in-process API.           */
+/*                                                                       */
+/* band_setup() does the once-per-process work: pinning the ROI thread,  */
+/* timer calibration, and opening the energy and frequency counters.     */
+/* band_run() then allocates the arrays as configured, runs the timed    */
+/* loop over Copy/Scale/Add/Triad and any extra registry kernels         */
+/* (stream_registry.h), validates the result and frees the arrays.       */
+/* The RunResult it fills is the one the CLI prints and writes as JSON   */
+/* or CSV (stream_output.h). A caller that keeps its arrays between runs */
+/* uses band_alloc / band_measure / band_validate / band_free instead.   */
+/*                                                                       */
+/* The element type is STREAM_TYPE, fixed when the library is built.     */
+/* Nothing here prints to stdout; band_validate() and band_run() write  */
+/* the checkSTREAMresults report to the FILE they are given.             */
+/*-----------------------------------------------------------------------*/
+#ifndef BANDSTREAM_H
+#define BANDSTREAM_H
+
+# include <stdint.h>
+# include <stdio.h>
+# include <string>
+# include <vector>
+# include "stream_kernels.h"
+# include "stream_registry.h"
+# include "stream_output.h"
+# include "stream_timer.h"
+# include "roi_counter.h"
+
+/*
+ * Seed for the initial array contents. band_validate() replays the same
+ * rand() sequence to recover the initial a[] for validation.
+ */
+#ifndef INIT_SEED
+#   define INIT_SEED	1
+#endif
+
+/*
+ * Default stagger of the arrays in elements, as in the original STREAM
+ * layout: a starts at its aligned base, b OFFSET and c 2*OFFSET past
+ * theirs (BandConfig::offsets)
+ */
+#ifndef OFFSET
+#   define OFFSET	0
+#endif
+
+/* The constant of Scale and Triad */
+# define BAND_SCALAR	3.0
+
+/*
+ * How the arrays get their memory. The mmap backings fault in from the
+ * initializing thread like malloc, or at mmap() time with 'populate'.
+ * File backings map an unlinked file, so nothing is left behind.
+ */
+enum BandPlacement {
+	BAND_PLACE_MALLOC = 0,		/* malloc; pages faulted in by the initializing thread */
+	BAND_PLACE_FIRST_TOUCH,		/* malloc; each thread faults in its own chunk first */
+	BAND_PLACE_ANON,		/* private anonymous mmap */
+	BAND_PLACE_TMPFS,		/* shared mmap of a file in BAND_TMPFS_DIR */
+	BAND_PLACE_FILE			/* shared mmap of a file in map_dir: the page cache */
+};
+
+#ifndef BAND_TMPFS_DIR
+#   define BAND_TMPFS_DIR	"/dev/shm"
+#endif
+
+/* Directory of BAND_PLACE_FILE when neither map_dir nor $TMPDIR is set */
+#ifndef BAND_FILE_DIR
+#   define BAND_FILE_DIR	"/var/tmp"
+#endif
+
+struct BandConfig {
+	uint64_t	num_elements;	/* per array */
+	int		ntimes;		/* iterations, the first one is warm-up */
+	int		threads;	/* OpenMP threads; 0 = the OpenMP default */
+	BandPlacement	placement;
+	bool		populate;	/* mmap backings: MAP_POPULATE */
+	std::string	map_dir;	/* BAND_PLACE_FILE; empty = $TMPDIR or BAND_FILE_DIR */
+	size_t		align;		/* base of each array, a power of two; 0 = the allocator's */
+	size_t		offsets[3];	/* bytes past the aligned base of a, b, c */
+	const KernelSet	*kernels;	/* NULL = kernel_set_default() */
+	KernelParams	params;		/* kernel_params while band_measure() runs */
+	RoiMode		roi_mode;
+	int		roi_iteration;	/* with ROI_KERNEL: only this one, -1 = all */
+	bool		exit_after_roi;	/* GEM5_RV64: m5_exit as soon as the ROI ends */
+	/* Opt-in registry kernels, timed after the STREAM four in this order */
+	std::vector<const StreamKernel *> extra;
+
+	BandConfig();
+};
+
+struct BandArrays {
+	STREAM_TYPE	*a;
+	STREAM_TYPE	*b;
+	STREAM_TYPE	*c;
+	uint64_t	n;
+	BandPlacement	placement;
+	bool		populate;
+	size_t		align;
+	size_t		offsets[3];
+	char		*base[3];	/* as allocated or mapped; a, b, c lie past them */
+	size_t		map_bytes[3];	/* mapped lengths, 0 = malloc */
+	double		setup_s;	/* allocating and faulting in a, b, c */
+	uint64_t	setup_faults;	/* page faults taken meanwhile */
+	std::vector<const StreamKernel *> kernels;	/* timed, in order */
+	std::vector<KernelContext> ctx;			/* one per kernel */
+};
+
+/*
+ * Once per process, before any measurement. 'lproc_id' is the CPU the
+ * calling (ROI) thread is pinned to in PCM builds; elsewhere it is only
+ * recorded. Returns 0.
+ */
+int band_setup(int32_t lproc_id, TimerSource timer = TIMER_AUTO);
+
+/*
+ * Parse / name a placement: "malloc", "first-touch", "anon", "tmpfs" or
+ * "file"; the mmap ones take a "+populate" suffix
+ */
+bool band_parse_placement(const char *name, BandPlacement *p, bool *populate);
+std::string band_placement_name(BandPlacement p, bool populate);
+
+/*
+ * Allocate and initialize a, b, c and set up every kernel; 0 on success,
+ * else -1 and *err says why. Offsets must be multiples of STREAM_TYPE.
+ */
+int band_alloc(const BandConfig &cfg, BandArrays *arr, std::string *err);
+
+/*
+ * Back to the initial contents, as band_validate() expects before a run;
+ * runs every kernel's setup() again to refill its state
+ */
+void band_reset(BandArrays *arr);
+
+void band_free(BandArrays *arr);
+
+/*
+ * The timed loop over freshly reset arrays: cfg.ntimes iterations of
+ * every kernel in arr->kernels, ROI counters around it. Fills everything in *res except
+ * validation_errors. Returns 0.
+ */
+int band_measure(const BandConfig &cfg, BandArrays *arr, RunResult *res);
+
+/* The RunConfig of a measurement of 'arr' under 'cfg', as band_measure() records it */
+void band_describe(const BandConfig &cfg, const BandArrays &arr, RunConfig *c);
+
+/*
+ * checkSTREAMresults() plus each extra kernel's verify(): number of arrays
+ * off by more than epsilon plus failed extra checks. The messages go to
+ * 'report' (NULL: none).
+ */
+int band_validate(const BandArrays &arr, int ntimes, FILE *report);
+
+/* band_alloc + band_measure + band_validate + band_free */
+int band_run(const BandConfig &cfg, RunResult *res, std::string *err, FILE *report);
+
+#endif /* BANDSTREAM_H */
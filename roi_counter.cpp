@@ -0,0 +1,178 @@
+/*-----------------------------------------------------------------------*/
+/* Region-of-interest counters around the STREAM timed loop.             */
+/*-----------------------------------------------------------------------*/
+# include "roi_counter.h"
+
+ROICounter & ROICounter::operator - (const ROICounter & o) {
+	ticks = this->ticks - o.ticks;
+	pkg_energy_j = this->pkg_energy_j - o.pkg_energy_j;
+	dram_energy_j = this->dram_energy_j - o.dram_energy_j;
+	for (int t = 0; t < freq.threads && t < o.freq.threads; t++) {
+		freq.cycles[t] -= o.freq.cycles[t];
+		freq.ref_cycles[t] -= o.freq.ref_cycles[t];
+	}
+	#if (__amd64__) && (USE_PCM)
+	struct __eco_roi_stats_struct  tmp = __eco_counter_diff(counter_state, o.counter_state);
+	tsc = tmp.tsc;
+	instret = tmp.instret;
+	cpu_cycles = tmp.cpu_cycles;
+	l1d_miss = tmp.l1d_miss;
+	l1d_hits = tmp.l1d_hits;
+	l2_miss = tmp.l2_miss;
+	l2_hits = tmp.l2_hits;
+	l3_miss = tmp.l3_miss;
+	l3_hits = tmp.l3_hits;
+	#else
+	tsc = this->tsc - o.tsc;
+	instret = 0;
+	cpu_cycles = 0;
+	l1d_miss = 0;
+	l1d_hits = 0;
+	l2_miss = 0;
+	l2_hits = 0;
+	l3_miss = 0;
+	l3_hits = 0;
+	#endif
+	return *this;
+}
+
+void ROICounter::mark_roi() {
+	#if (__amd64__) && (USE_PCM)
+   	counter_state = __eco_roi_begin(lproc_id);
+   	#endif
+	ticks = timer_ticks();
+	#if (__amd64__) && (USE_PCM)
+	tsc = __eco_rdtsc();
+	#else
+	tsc = ticks;
+	#endif
+	instret = -1;
+	cpu_cycles = -1;
+	l1d_miss = -1;
+	l1d_hits = -1;
+	l2_miss = -1;
+	l2_hits = -1;
+	l3_miss = -1;
+	l3_hits = -1;
+	if (energy_available()) {
+		EnergyReading e;
+		energy_read(&e);
+		pkg_energy_j = e.pkg_j;
+		dram_energy_j = e.dram_j;
+	}
+	freq_read(&freq);
+}
+
+void ROICounter::start_roi() {
+	#ifdef GEM5_RV64
+	m5_reset_stats(0,0);
+	#endif
+	mark_roi();
+}
+
+
+void ROICounter::stop_roi() {
+	#ifdef GEM5_RV64
+	 m5_dump_stats(0,0);
+	#endif
+	mark_roi();
+}
+
+RoiMetrics ROICounter::metrics() const {
+	RoiMetrics m;
+	m.tsc = tsc;
+	m.instret = instret;
+	m.cpu_cycles = cpu_cycles;
+	m.l1d_miss = l1d_miss;
+	m.l1d_hits = l1d_hits;
+	m.l2_miss = l2_miss;
+	m.l2_hits = l2_hits;
+	m.l3_miss = l3_miss;
+	m.l3_hits = l3_hits;
+	m.pkg_energy_j = pkg_energy_j;
+	m.dram_energy_j = dram_energy_j;
+	m.freq = freq;
+	m.elapsed_s = timer_seconds(ticks);
+	return m;
+}
+
+void roi_metrics_zero(RoiMetrics *m) {
+	m->tsc = 0;
+	m->instret = 0;
+	m->cpu_cycles = 0;
+	m->l1d_miss = 0;
+	m->l1d_hits = 0;
+	m->l2_miss = 0;
+	m->l2_hits = 0;
+	m->l3_miss = 0;
+	m->l3_hits = 0;
+	m->pkg_energy_j = 0.0;
+	m->dram_energy_j = 0.0;
+	m->freq.threads = 0;
+	for (int t = 0; t < ROI_FREQ_THREADS; t++)
+		m->freq.cycles[t] = m->freq.ref_cycles[t] = 0;
+	m->elapsed_s = 0.0;
+}
+
+void roi_metrics_add(RoiMetrics *acc, const RoiMetrics &d) {
+	acc->tsc += d.tsc;
+	acc->instret += d.instret;
+	acc->cpu_cycles += d.cpu_cycles;
+	acc->l1d_miss += d.l1d_miss;
+	acc->l1d_hits += d.l1d_hits;
+	acc->l2_miss += d.l2_miss;
+	acc->l2_hits += d.l2_hits;
+	acc->l3_miss += d.l3_miss;
+	acc->l3_hits += d.l3_hits;
+	acc->pkg_energy_j += d.pkg_energy_j;
+	acc->dram_energy_j += d.dram_energy_j;
+	for (int t = 0; t < d.freq.threads; t++) {
+		acc->freq.cycles[t] += d.freq.cycles[t];
+		acc->freq.ref_cycles[t] += d.freq.ref_cycles[t];
+	}
+	if (d.freq.threads > acc->freq.threads)
+		acc->freq.threads = d.freq.threads;
+	acc->elapsed_s += d.elapsed_s;
+}
+
+KernelROI::KernelROI(int32_t lproc_id, RoiMode mode, int iteration,
+                     const std::vector<std::string> &names) :
+	mode(mode),
+	iteration(iteration),
+	names(names),
+	start(lproc_id),
+	stop(lproc_id),
+	sum(names.size()),
+	samples(names.size(), 0) {
+	for (size_t i = 0; i < sum.size(); i++)
+		roi_metrics_zero(&sum[i]);
+}
+
+void KernelROI::begin(int kernel, int k) {
+	if (!selected(k))
+		return;
+	#ifdef GEM5_RV64
+	m5_work_begin(kernel, 0);
+	#else
+	(void)kernel;
+	#endif
+	start.start_roi();
+}
+
+void KernelROI::end(int kernel, int k) {
+	if (!selected(k))
+		return;
+	stop.stop_roi();
+	#ifdef GEM5_RV64
+	m5_work_end(kernel, 0);
+	#else
+	(void)kernel;
+	#endif
+	RoiDump d;
+	d.index = dumps.size();
+	d.kernel = names[kernel];
+	d.iteration = k;
+	dumps.push_back(d);
+	roi_metrics_add(&sum[kernel], (stop - start).metrics());
+	samples[kernel]++;
+}
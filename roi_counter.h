@@ -0,0 +1,136 @@
+/*-----------------------------------------------------------------------*/
+/* Region-of-interest counters around the STREAM timed loop.             */
+/*-----------------------------------------------------------------------*/
+#ifndef ROI_COUNTER_H
+#define ROI_COUNTER_H
+
+# include <stdint.h>
+# include <stddef.h>
+# include <string>
+# include <vector>
+# include "stream_timer.h"
+# include "roi_energy.h"
+# include "roi_freq.h"
+
+#ifdef GEM5_RV64
+#include "gem5/m5ops.h"
+#elif (__amd64__) && (USE_PCM)
+#include "roi_hooks.h"
+#include "cpu_uarch.h"
+#include "errordefs.h"
+#endif
+
+/* Plain snapshot of a ROICounter, for reporting */
+struct RoiMetrics {
+	uint64_t tsc;
+	uint64_t instret;
+	uint64_t cpu_cycles;
+	uint64_t l1d_miss;
+	uint64_t l1d_hits;
+	uint64_t l2_miss;
+	uint64_t l2_hits;
+	uint64_t l3_miss;
+	uint64_t l3_hits;
+	double   pkg_energy_j;	/* RAPL, all packages; 0 without energy */
+	double   dram_energy_j;
+	FreqSnapshot freq;	/* per-thread core/reference cycles */
+	double   elapsed_s;	/* wall time from the calibrated timer */
+};
+
+class ROICounter {
+	private	:
+		int32_t lproc_id;
+		uint64_t ticks;
+		uint64_t tsc;
+		uint64_t instret;
+		uint64_t cpu_cycles;
+		uint64_t l1d_miss;
+		uint64_t l1d_hits;
+		uint64_t l2_miss;
+		uint64_t l2_hits;
+		uint64_t l3_miss;
+		uint64_t l3_hits;
+		double pkg_energy_j;
+		double dram_energy_j;
+		FreqSnapshot freq;
+		#if (__amd64__) && (USE_PCM)
+		core_counter_state_ptr_t counter_state;
+		#endif
+	public :
+		ROICounter(int32_t lproc_id) :
+			lproc_id(lproc_id),
+			ticks(0),
+			tsc(0),
+			instret(0),
+			cpu_cycles(0),
+			l1d_miss(0),
+			l1d_hits(0),
+			l2_miss(0),
+			l2_hits(0),
+			l3_miss(0),
+			l3_hits(0),
+			pkg_energy_j(0.0),
+			dram_energy_j(0.0)
+			#if (__amd64__) && (USE_PCM)
+			, counter_state(NULL)
+			#endif
+			{ freq.threads = 0; }
+			
+		void mark_roi();
+		void start_roi();
+		void stop_roi();
+		ROICounter & operator - (const ROICounter & o);
+		RoiMetrics metrics() const;
+};
+
+void roi_metrics_zero(RoiMetrics *m);
+void roi_metrics_add(RoiMetrics *acc, const RoiMetrics &d);
+
+/*
+ * Where the ROI boundaries go:
+ *   ROI_LOOP    one region around the whole NTIMES loop (the default)
+ *   ROI_KERNEL  one region around every kernel invocation, so that gem5
+ *               reset/dump pairs and counter deltas never mix kernels
+ */
+enum RoiMode {
+	ROI_LOOP = 0,
+	ROI_KERNEL
+};
+
+/* One m5_dump_stats() issued in ROI_KERNEL mode, in dump order */
+struct RoiDump {
+	unsigned	index;		/* n-th dump of this run */
+	std::string	kernel;
+	int		iteration;
+};
+
+/*
+ * Per-kernel ROI bookkeeping for ROI_KERNEL mode. begin()/end() bracket
+ * one kernel invocation outside its timed region; nothing is printed
+ * from inside the loop, dumps are only recorded for later reporting.
+ * Under GEM5_RV64 each region is also an m5 work item whose id is the
+ * kernel index, so gem5's own work-item stats carry the same tag.
+ */
+class KernelROI {
+	private :
+		RoiMode mode;
+		int iteration;		/* only this iteration, or -1 for all */
+		std::vector<std::string> names;
+		ROICounter start;
+		ROICounter stop;
+	public :
+		std::vector<RoiMetrics> sum;	/* per kernel, over selected iterations */
+		std::vector<unsigned> samples;
+		std::vector<RoiDump> dumps;
+
+		KernelROI(int32_t lproc_id, RoiMode mode, int iteration,
+		          const std::vector<std::string> &names);
+
+		bool selected(int k) const {
+			return mode == ROI_KERNEL && (iteration < 0 || iteration == k);
+		}
+		void begin(int kernel, int k);
+		void end(int kernel, int k);
+};
+
+#endif /* ROI_COUNTER_H */
@@ -0,0 +1,321 @@
+/*-----------------------------------------------------------------------*/
+/* Package and DRAM energy for the ROI counters (RAPL).                  */
+/*-----------------------------------------------------------------------*/
+# include <stdio.h>
+# include <stdint.h>
+# include <string.h>
+# include <string>
+# include <vector>
+# include "roi_energy.h"
+
+#if defined(__linux__) && !defined(GEM5_RV64)
+# include <fcntl.h>
+# include <time.h>
+# include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+# include <cpuid.h>
+#endif
+
+/* RAPL MSRs (Intel SDM vol. 4; AMD PPR, family 17h and later) */
+# define MSR_RAPL_POWER_UNIT		0x606
+# define MSR_PKG_ENERGY_STATUS		0x611
+# define MSR_DRAM_ENERGY_STATUS		0x619
+# define MSR_AMD_RAPL_POWER_UNIT	0xc0010299
+# define MSR_AMD_PKG_ENERGY_STATUS	0xc001029b
+
+/* DRAM energy unit on server parts that ignore the ESU for DRAM (2^-16 J) */
+# define RAPL_DRAM_SERVER_UNIT_J	(1.0 / 65536.0)
+
+/* Upper bound on one domain's power, used to bound the wrap period */
+#ifndef ENERGY_MAX_WATTS
+#   define ENERGY_MAX_WATTS 1000.0
+#endif
+
+struct EnergyDomain {
+	bool		dram;
+	int		fd;		/* msr source: /dev/cpu/N/msr */
+	uint32_t	msr;
+	std::string	path;		/* powercap source: energy_uj */
+	double		unit_j;		/* joules per raw count */
+	uint64_t	range;		/* raw counts before the counter wraps */
+	uint64_t	last;
+	uint64_t	total;		/* raw counts since energy_init() */
+};
+
+static std::vector<EnergyDomain> domains;
+static const char *source = "none";
+static double poll_s = 0.0;		/* fold at least this often */
+static double last_fold_s = 0.0;
+
+static bool read_u64_file(const std::string &path, uint64_t *v) {
+	FILE *fp = fopen(path.c_str(), "r");
+	if (fp == NULL)
+		return false;
+	unsigned long long x;
+	bool ok = fscanf(fp, "%llu", &x) == 1;
+	fclose(fp);
+	*v = x;
+	return ok;
+}
+
+static std::string read_line_file(const std::string &path) {
+	char buf[64] = "";
+	FILE *fp = fopen(path.c_str(), "r");
+	if (fp == NULL)
+		return "";
+	if (fgets(buf, sizeof(buf), fp) == NULL)
+		buf[0] = '\0';
+	fclose(fp);
+	buf[strcspn(buf, "\n")] = '\0';
+	return buf;
+}
+
+static bool read_raw(const EnergyDomain &d, uint64_t *raw) {
+	if (d.fd < 0)
+		return read_u64_file(d.path, raw);
+	uint64_t v;
+	if (pread(d.fd, &v, sizeof(v), d.msr) != sizeof(v))
+		return false;
+	*raw = v & 0xffffffffULL;
+	return true;
+}
+
+/* A powercap zone is usable only if energy_uj is readable (root-only on most kernels) */
+static void add_powercap_zone(const std::string &dir) {
+	std::string name = read_line_file(dir + "/name");
+	EnergyDomain d;
+	if (name.compare(0, 8, "package-") == 0)
+		d.dram = false;
+	else if (name == "dram")
+		d.dram = true;
+	else
+		return;
+	d.fd = -1;
+	d.msr = 0;
+	d.path = dir + "/energy_uj";
+	d.unit_j = 1.0E-06;
+	if (!read_u64_file(dir + "/max_energy_range_uj", &d.range))
+		d.range = 0;
+	d.range += 1;
+	if (!read_raw(d, &d.last))
+		return;
+	d.total = 0;
+	domains.push_back(d);
+}
+
+static int init_powercap() {
+	for (int p = 0; ; p++) {
+		char dir[64];
+		snprintf(dir, sizeof(dir), "/sys/class/powercap/intel-rapl:%d", p);
+		if (access(dir, F_OK) != 0)
+			break;
+		add_powercap_zone(dir);
+		for (int z = 0; ; z++) {
+			char sub[80];
+			snprintf(sub, sizeof(sub), "%s/intel-rapl:%d:%d", dir, p, z);
+			if (access(sub, F_OK) != 0)
+				break;
+			add_powercap_zone(sub);
+		}
+	}
+	return domains.size();
+}
+
+static bool cpu_is_amd() {
+#if defined(__x86_64__) || defined(__i386__)
+	unsigned int eax, ebx, ecx, edx;
+	if (!__get_cpuid(0, &eax, &ebx, &ecx, &edx))
+		return false;
+	return ebx == 0x68747541 && edx == 0x69746e65 && ecx == 0x444d4163; /* AuthenticAMD */
+#else
+	return false;
+#endif
+}
+
+/*
+ * Haswell-EP and later Xeon (and Xeon Phi) parts count DRAM energy in a
+ * fixed 15.3 uJ unit regardless of MSR_RAPL_POWER_UNIT, as the Linux
+ * intel_rapl driver also assumes.
+ */
+static bool cpu_has_server_dram_unit() {
+#if defined(__x86_64__) || defined(__i386__)
+	unsigned int eax, ebx, ecx, edx;
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+		return false;
+	unsigned int family = (eax >> 8) & 0xf;
+	unsigned int model = ((eax >> 4) & 0xf) | (((eax >> 16) & 0xf) << 4);
+	if (family != 6)
+		return false;
+	switch (model) {
+	case 0x3f:	/* Haswell-EP */
+	case 0x4f:	/* Broadwell-EP */
+	case 0x56:	/* Broadwell-DE */
+	case 0x55:	/* Skylake-SP, Cascade Lake, Cooper Lake */
+	case 0x6a:	/* Ice Lake-SP */
+	case 0x6c:	/* Ice Lake-D */
+	case 0x8f:	/* Sapphire Rapids */
+	case 0xcf:	/* Emerald Rapids */
+	case 0xad:	/* Granite Rapids */
+	case 0xae:	/* Granite Rapids-D */
+	case 0xaf:	/* Sierra Forest */
+	case 0x57:	/* Knights Landing */
+	case 0x85:	/* Knights Mill */
+		return true;
+	}
+#endif
+	return false;
+}
+
+static void add_msr_domain(int fd, uint32_t msr, bool dram, double unit_j) {
+	EnergyDomain d;
+	d.dram = dram;
+	d.fd = fd;
+	d.msr = msr;
+	d.unit_j = unit_j;
+	d.range = 1ULL << 32;
+	d.total = 0;
+	if (read_raw(d, &d.last))
+		domains.push_back(d);
+}
+
+/* One CPU per physical package, each domain read through its msr device */
+static int init_msr() {
+	bool amd = cpu_is_amd();
+	bool server_dram = !amd && cpu_has_server_dram_unit();
+	std::vector<long> seen;
+	for (int cpu = 0; ; cpu++) {
+		char path[96];
+		snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+		uint64_t pkg;
+		if (!read_u64_file(path, &pkg))
+			break;
+		bool dup = false;
+		for (size_t i = 0; i < seen.size(); i++)
+			dup = dup || seen[i] == (long)pkg;
+		if (dup)
+			continue;
+		seen.push_back(pkg);
+
+		snprintf(path, sizeof(path), "/dev/cpu/%d/msr", cpu);
+		int fd = open(path, O_RDONLY);
+		if (fd < 0)
+			continue;
+		uint64_t units;
+		uint32_t unit_msr = amd ? MSR_AMD_RAPL_POWER_UNIT : MSR_RAPL_POWER_UNIT;
+		if (pread(fd, &units, sizeof(units), unit_msr) != sizeof(units)) {
+			close(fd);
+			continue;
+		}
+		/* Energy status unit: bits 12:8, in 1/2^ESU joules */
+		double unit_j = 1.0 / (double)(1ULL << ((units >> 8) & 0x1f));
+		add_msr_domain(fd, amd ? MSR_AMD_PKG_ENERGY_STATUS : MSR_PKG_ENERGY_STATUS, false, unit_j);
+		if (!amd)
+			add_msr_domain(fd, MSR_DRAM_ENERGY_STATUS, true,
+				       server_dram ? RAPL_DRAM_SERVER_UNIT_J : unit_j);
+	}
+	return domains.size();
+}
+
+static double monotonic_s() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + 1.0E-09 * ts.tv_nsec;
+}
+
+/* Fold every domain's raw counter into its running total */
+static void fold_all() {
+	for (size_t i = 0; i < domains.size(); i++) {
+		EnergyDomain &d = domains[i];
+		uint64_t raw;
+		if (read_raw(d, &raw)) {
+			d.total += raw >= d.last ? raw - d.last : raw + d.range - d.last;
+			d.last = raw;
+		}
+	}
+	last_fold_s = monotonic_s();
+}
+
+int energy_init() {
+	domains.clear();
+	if (init_powercap() > 0)
+		source = "powercap";
+	else if (init_msr() > 0)
+		source = "msr";
+	else
+		source = "none";
+	/* Half the shortest wrap period at ENERGY_MAX_WATTS */
+	poll_s = 0.0;
+	for (size_t i = 0; i < domains.size(); i++) {
+		double wrap_s = domains[i].range * domains[i].unit_j / ENERGY_MAX_WATTS;
+		if (poll_s == 0.0 || wrap_s / 2 < poll_s)
+			poll_s = wrap_s / 2;
+	}
+	last_fold_s = monotonic_s();
+	return domains.size();
+}
+
+void energy_poll() {
+	if (!domains.empty() && monotonic_s() - last_fold_s >= poll_s)
+		fold_all();
+}
+
+double energy_poll_interval() {
+	return poll_s;
+}
+
+void energy_read(EnergyReading *r) {
+	r->pkg_j = 0.0;
+	r->dram_j = 0.0;
+	fold_all();
+	for (size_t i = 0; i < domains.size(); i++) {
+		const EnergyDomain &d = domains[i];
+		if (d.dram)
+			r->dram_j += d.total * d.unit_j;
+		else
+			r->pkg_j += d.total * d.unit_j;
+	}
+}
+
+int energy_domains(int *pkg, int *dram) {
+	*pkg = 0;
+	*dram = 0;
+	for (size_t i = 0; i < domains.size(); i++)
+		(domains[i].dram ? *dram : *pkg)++;
+	return domains.size();
+}
+
+#else /* no RAPL on this target */
+
+static const char *source = "none";
+
+int energy_init() {
+	return 0;
+}
+
+void energy_poll() {
+}
+
+double energy_poll_interval() {
+	return 0.0;
+}
+
+void energy_read(EnergyReading *r) {
+	r->pkg_j = 0.0;
+	r->dram_j = 0.0;
+}
+
+int energy_domains(int *pkg, int *dram) {
+	*pkg = 0;
+	*dram = 0;
+	return 0;
+}
+
+#endif
+
+bool energy_available() {
+	return strcmp(source, "none") != 0;
+}
+
+const char *energy_source() {
+	return source;
+}
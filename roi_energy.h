@@ -0,0 +1,44 @@
+/*-----------------------------------------------------------------------*/
+/* Package and DRAM energy for the ROI counters (RAPL).                  */
+/*                                                                       */
+/* Sources, in order of preference:                                      */
+/*   powercap  /sys/class/powercap/intel-rapl:N[:M]/energy_uj, package   */
+/*             and dram zones (also used by the kernel's AMD RAPL driver) */
+/*   msr       /dev/cpu/N/msr on one CPU per package, Intel or AMD RAPL  */
+/*             registers; needs the msr module and CAP_SYS_RAWIO         */
+/* The hardware counters wrap (max_energy_range_uj, or 2^32 MSR counts); */
+/* every read folds the raw value into a 64-bit running total per        */
+/* domain. A ROI can outlast a wrap period, so long-running loops call   */
+/* energy_poll() between kernels to fold at least twice per period.      */
+/* The MSR source uses the fixed 2^-16 J DRAM unit of Haswell-EP and     */
+/* later Xeons instead of the package energy status unit.                */
+/*-----------------------------------------------------------------------*/
+#ifndef ROI_ENERGY_H
+#define ROI_ENERGY_H
+
+/* Cumulative energy since energy_init(), summed over packages */
+struct EnergyReading {
+	double	pkg_j;
+	double	dram_j;
+};
+
+/* Discover the domains; returns how many were found (0: no energy) */
+int energy_init();
+
+bool energy_available();
+
+/* "powercap", "msr" or "none" */
+const char *energy_source();
+
+/* Number of package and DRAM domains found by energy_init() */
+int energy_domains(int *pkg, int *dram);
+
+void energy_read(EnergyReading *r);
+
+/* Fold the counters if half the shortest wrap period has passed; cheap otherwise */
+void energy_poll();
+
+/* Seconds between the folds energy_poll() takes (0: no energy) */
+double energy_poll_interval();
+
+#endif /* ROI_ENERGY_H */
@@ -0,0 +1,249 @@
+/*-----------------------------------------------------------------------*/
+/* Effective core frequency of every worker thread for the ROI counters. */
+/*-----------------------------------------------------------------------*/
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
+# include <math.h>
+# include <stdio.h>
+# include <string.h>
+# include "roi_freq.h"
+# include "stream_timer.h"
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
+static const char *source = "none";
+static int nthreads;
+static int team_size;		/* team the counters were opened for */
+static double ref_hz;
+
+#if defined(__linux__) && !defined(GEM5_RV64)
+# include <fcntl.h>
+# include <sched.h>
+# include <unistd.h>
+# include <sys/ioctl.h>
+# include <sys/syscall.h>
+# include <linux/perf_event.h>
+
+# define MSR_IA32_MPERF	0xe7
+# define MSR_IA32_APERF	0xe8
+
+static int group_fd[ROI_FREQ_THREADS];	/* perf_event: leader (cycles) */
+static int member_fd[ROI_FREQ_THREADS];	/* perf_event: ref-cycles */
+static int msr_fd[ROI_FREQ_THREADS];	/* msr: /dev/cpu/N/msr */
+static long owner[ROI_FREQ_THREADS];	/* perf_event: tid, msr: CPU counted */
+
+/* What a thread's counters are tied to under the current source */
+static long thread_key(bool msr) {
+	return msr ? (long)sched_getcpu() : (long)syscall(SYS_gettid);
+}
+
+static int perf_open(uint64_t config, int group) {
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.config = config;
+	attr.read_format = PERF_FORMAT_GROUP;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	return syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+/* Called by every thread of the team for itself */
+static bool open_perf(int t) {
+	int leader = perf_open(PERF_COUNT_HW_CPU_CYCLES, -1);
+	if (leader < 0)
+		return false;
+	int member = perf_open(PERF_COUNT_HW_REF_CPU_CYCLES, leader);
+	if (member < 0) {
+		close(leader);
+		return false;
+	}
+	group_fd[t] = leader;
+	member_fd[t] = member;
+	owner[t] = thread_key(false);
+	return true;
+}
+
+static bool open_msr(int t) {
+	char path[32];
+	snprintf(path, sizeof(path), "/dev/cpu/%d/msr", sched_getcpu());
+	msr_fd[t] = open(path, O_RDONLY);
+	owner[t] = thread_key(true);
+	return msr_fd[t] >= 0;
+}
+
+/* Every thread must succeed, or the source is not used at all */
+static int open_team(bool (*open_one)(int)) {
+	int ok = 0, team = 1;
+	#pragma omp parallel reduction(+:ok)
+	{
+		#ifdef _OPENMP
+		int t = omp_get_thread_num();
+		#pragma omp single
+		team = omp_get_num_threads();
+		#else
+		int t = 0;
+		#endif
+		if (t < ROI_FREQ_THREADS && open_one(t))
+			ok++;
+	}
+	team_size = team;
+	if (team > ROI_FREQ_THREADS) {
+		fprintf(stderr, "WARNING: frequency tracked for the first %d of %d threads\n",
+			ROI_FREQ_THREADS, team);
+		team = ROI_FREQ_THREADS;
+	}
+	return ok == team ? team : 0;
+}
+
+static bool team_pinned() {
+	int pinned = 0, team = 1;
+	#pragma omp parallel reduction(+:pinned)
+	{
+		cpu_set_t set;
+		#ifdef _OPENMP
+		#pragma omp single
+		team = omp_get_num_threads();
+		#endif
+		if (sched_getaffinity(0, sizeof(set), &set) == 0 && CPU_COUNT(&set) == 1)
+			pinned++;
+	}
+	return pinned == team;
+}
+
+/* The reference clock is the TSC rate; the base frequency if we are not on the TSC */
+static double reference_hz() {
+	if (timer_info.source == TIMER_TSC)
+		return timer_info.hz;
+	FILE *fp = fopen("/sys/devices/system/cpu/cpu0/cpufreq/base_frequency", "r");
+	double khz = 0.0;
+	if (fp != NULL) {
+		if (fscanf(fp, "%lf", &khz) != 1)
+			khz = 0.0;
+		fclose(fp);
+	}
+	return khz * 1.0E+03;
+}
+
+static void close_all() {
+	for (int t = 0; t < ROI_FREQ_THREADS; t++) {
+		if (group_fd[t] >= 0)
+			close(group_fd[t]);
+		if (member_fd[t] >= 0)
+			close(member_fd[t]);
+		if (msr_fd[t] >= 0)
+			close(msr_fd[t]);
+		group_fd[t] = member_fd[t] = msr_fd[t] = -1;
+	}
+}
+
+int freq_init() {
+	for (int t = 0; t < ROI_FREQ_THREADS; t++)
+		group_fd[t] = member_fd[t] = msr_fd[t] = -1;
+	source = "none";
+	if ((nthreads = open_team(open_perf)) > 0)
+		source = "perf_event";
+	else {
+		close_all();
+		if (team_pinned() && (nthreads = open_team(open_msr)) > 0)
+			source = "msr";
+		else
+			close_all();
+	}
+	ref_hz = reference_hz();
+	return nthreads;
+}
+
+int freq_sync() {
+	if (nthreads == 0)
+		return 0;
+	const bool msr = strcmp(source, "msr") == 0;
+	int same = 0, team = 1;
+	#pragma omp parallel reduction(+:same)
+	{
+		#ifdef _OPENMP
+		int t = omp_get_thread_num();
+		#pragma omp single
+		team = omp_get_num_threads();
+		#else
+		int t = 0;
+		#endif
+		if (t < nthreads && owner[t] == thread_key(msr))
+			same++;
+	}
+	if (team == team_size && same == nthreads)
+		return nthreads;
+	close_all();
+	if (freq_init() == 0)
+		fprintf(stderr, "WARNING: frequency counters cannot follow the new OpenMP team; not reported\n");
+	return nthreads;
+}
+
+void freq_read(FreqSnapshot *s) {
+	s->threads = nthreads;
+	for (int t = 0; t < nthreads; t++) {
+		uint64_t v[3] = { 0, 0, 0 };	/* nr, cycles, ref-cycles */
+		if (group_fd[t] >= 0) {
+			if (read(group_fd[t], v, sizeof(v)) != sizeof(v))
+				v[1] = v[2] = 0;
+		} else if (pread(msr_fd[t], &v[1], sizeof(v[1]), MSR_IA32_APERF) != sizeof(v[1]) ||
+		           pread(msr_fd[t], &v[2], sizeof(v[2]), MSR_IA32_MPERF) != sizeof(v[2]))
+			v[1] = v[2] = 0;
+		s->cycles[t] = v[1];
+		s->ref_cycles[t] = v[2];
+	}
+}
+
+#else /* no frequency counters on this target */
+
+int freq_init() {
+	return 0;
+}
+
+int freq_sync() {
+	return 0;
+}
+
+void freq_read(FreqSnapshot *s) {
+	s->threads = 0;
+}
+
+#endif
+
+bool freq_available() {
+	return nthreads > 0;
+}
+
+const char *freq_source() {
+	return source;
+}
+
+double freq_ref_hz() {
+	return ref_hz;
+}
+
+double freq_ghz(const FreqSnapshot &d, int i) {
+	if (i >= d.threads || d.ref_cycles[i] == 0)
+		return NAN;
+	double ratio = (double)d.cycles[i] / d.ref_cycles[i];
+	return ref_hz > 0.0 ? 1.0E-09 * ratio * ref_hz : ratio;
+}
+
+void freq_summary(const FreqSnapshot &d, double *mean, double *min, double *max) {
+	int n = 0;
+	double sum = 0.0;
+	*min = *max = NAN;
+	for (int t = 0; t < d.threads; t++) {
+		double g = freq_ghz(d, t);
+		if (isnan(g))
+			continue;
+		sum += g;
+		*min = n == 0 ? g : fmin(*min, g);
+		*max = n == 0 ? g : fmax(*max, g);
+		n++;
+	}
+	*mean = n > 0 ? sum / n : NAN;
+}
@@ -0,0 +1,64 @@
+/*-----------------------------------------------------------------------*/
+/* Effective core frequency of every worker thread for the ROI counters. */
+/*                                                                       */
+/* Each OpenMP thread gets a pair of counters that stop while it is      */
+/* halted: core cycles at the actual clock and reference cycles at the   */
+/* constant (TSC) rate. cycles/ref_cycles times the reference rate is    */
+/* the average frequency the thread ran at, so a kernel slowed by DVFS   */
+/* or uncore throttling can be told apart from one limited by memory.    */
+/*   perf_event  cycles + ref-cycles, one group per thread (pid = tid)   */
+/*   msr         IA32_APERF / IA32_MPERF of the CPU each thread is on    */
+/*               when they are opened; needs pinned threads              */
+/*               (OMP_PROC_BIND=true)                                    */
+/* The counters belong to the team that opened them; freq_sync() opens   */
+/* them again when the team size, its threads or their CPUs change.      */
+/*-----------------------------------------------------------------------*/
+#ifndef ROI_FREQ_H
+#define ROI_FREQ_H
+
+# include <stdint.h>
+
+/* Threads tracked; any beyond are left out of the frequency report */
+#ifndef ROI_FREQ_THREADS
+#   define ROI_FREQ_THREADS	64
+#endif
+
+struct FreqSnapshot {
+	int		threads;	/* 0: no frequency counters */
+	uint64_t	cycles[ROI_FREQ_THREADS];
+	uint64_t	ref_cycles[ROI_FREQ_THREADS];
+};
+
+/*
+ * Open the counters from inside an OpenMP team of the size the kernels
+ * use. Returns the number of threads covered (0: not available).
+ */
+int freq_init();
+
+/*
+ * From outside a parallel region, before a measurement: reopen the
+ * counters if the current team is not the one they were opened for.
+ * Returns the threads covered (0: frequency no longer available).
+ */
+int freq_sync();
+
+bool freq_available();
+
+/* "perf_event", "msr" or "none" */
+const char *freq_source();
+
+/* Reference cycles per second; 0 if unknown (then only ratios are known) */
+double freq_ref_hz();
+
+void freq_read(FreqSnapshot *s);
+
+/*
+ * Effective GHz of thread i over a difference of two snapshots (the bare
+ * cycles/ref_cycles ratio if freq_ref_hz() is 0); NaN if it never ran.
+ */
+double freq_ghz(const FreqSnapshot &d, int i);
+
+/* Mean, min and max of freq_ghz() over the threads that ran; NaN if none */
+void freq_summary(const FreqSnapshot &d, double *mean, double *min, double *max);
+
+#endif /* ROI_FREQ_H */
@@ -48,15 +48,32 @@
 # include <stdint.h>
 # include <stdlib.h>
 # include <sys/time.h>
-
-#ifdef GEM5_RV64
-#include "gem5/m5ops.h"
-#elif (__amd64__) && (USE_PCM)
-#include "roi_hooks.h"
-#include "cpu_uarch.h"
-#include "errordefs.h"
+# include <string.h>
+# include <errno.h>
+# include <getopt.h>
+# include <algorithm>
+# include "stream_stats.h"
+# include "stream_output.h"
+# include "stream_baseline.h"
+# include "stream_timer.h"
+# include "stream_kernels.h"
+# include "stream_roofline.h"
+# include "stream_fused.h"
+# include "stream_sampler.h"
+# include "stream_interference.h"
+# include "stream_pingpong.h"
+# include "stream_atomics.h"
+# include "stream_faults.h"
+# include "stream_io.h"
+# include "stream_memcpy.h"
+# include "stream_ring.h"
+# include "bandstream.h"
+#ifdef _OPENMP
+# include <omp.h>
 #endif
 
+#include "roi_counter.h"
+
 /*-----------------------------------------------------------------------
  * INSTRUCTIONS:
  *
@@ -129,11 +146,19 @@
  *         STREAM_ARRAY_SIZE is set to a value close to a large power of 2.
  *      OFFSET can also be set on the compile line without changing the source
  *         code using, for example, "-DOFFSET=56".
+ *      The arrays are allocated separately here: OFFSET is the default
+ *         stagger of --offsets (b OFFSET and c 2*OFFSET elements past their
+ *         aligned bases), and --align fixes those bases at run time.
  */
 #ifndef OFFSET
 #   define OFFSET	0
 #endif
 
+/* Base alignment of --offset-sweep when --align is not given */
+#ifndef OFFSET_SWEEP_ALIGN
+#   define OFFSET_SWEEP_ALIGN	(2UL << 20)
+#endif
+
 /*
  *	3) Compile the code with optimization.  Many compilers generate
  *       unreasonably bad code before the optimizer tightens things up.  
@@ -186,120 +211,273 @@
 #define STREAM_TYPE double
 #endif
 
-void checkSTREAMresults(STREAM_TYPE *a, \
-                        STREAM_TYPE *b, \
-						STREAM_TYPE *c, \
-						unsigned num_element);
+/* Report label of a result's kernel, padded to the width of "Triad:     " */
+static std::string label(const KernelResult &k) {
+	const StreamKernel *sk = registry_find(k.name.c_str());
+	char buf[64];
+	snprintf(buf, sizeof(buf), "%-11s", ((sk != NULL ? sk->label : k.name.c_str()) + std::string(":")).c_str());
+	return buf;
+}
+
+void printStatistics(const RunResult &res);
+void warnConfigMismatch(const RunConfig &base, const RunConfig &cur);
+void printRoiDumps(const RunResult &res);
+void printEnergy(const RunResult &res);
+void printFrequency(const RunResult &res);
+void printPrefetchSweep(const std::vector<RunResult> &runs);
+void printOffsetSweep(const std::vector<RunResult> &runs);
 
-/* Initial arrays */
-void initializeArrays(STREAM_TYPE *arr_ptr, uint32_t num_elements) {
-	for (uint32_t i = 0; i < num_elements; i++) {
-		arr_ptr[i] = ((STREAM_TYPE)rand()/RAND_MAX)*2.0-1.0;
+/*
+ * The tail of every standalone mode: its report on stdout between HLINEs,
+ * then whichever of the JSON and CSV outputs were asked for
+ */
+template <class R>
+static void reportMode(const R &results, const char *json_path, const char *csv_path,
+                       void (*print)(FILE *, const R &),
+                       int (*write_json)(const char *, const R &),
+                       int (*write_csv)(const char *, const R &)) {
+	printf(HLINE);
+	print(stdout, results);
+	printf(HLINE);
+	if (json_path != NULL && write_json(json_path, results) != 0)
+		fprintf(stderr, "Failed to write JSON result to %s\n", json_path);
+	if (csv_path != NULL && write_csv(csv_path, results) != 0)
+		fprintf(stderr, "Failed to write CSV result to %s\n", csv_path);
+}
+
+/* Comma-separated registry kernel names */
+static bool parseKernels(const char *arg, std::vector<const StreamKernel *> *out) {
+	std::string list(arg);
+	size_t pos = 0;
+	out->clear();
+	while (pos <= list.size()) {
+		size_t end = list.find(',', pos);
+		if (end == std::string::npos)
+			end = list.size();
+		std::string name = list.substr(pos, end - pos);
+		const StreamKernel *k = registry_find(name.c_str());
+		if (k == NULL) {
+			fprintf(stderr, "Unknown kernel '%s'; available:\n", name.c_str());
+			registry_list(stderr);
+			return false;
+		}
+		out->push_back(k);
+		pos = end + 1;
 	}
+	return true;
 }
 
-class ROICounter {
-	private	:
-		int32_t lproc_id;
-		uint64_t tsc;
-		uint64_t instret;
-		uint64_t cpu_cycles;
-		uint64_t l1d_miss;
-		uint64_t l1d_hits;
-		uint64_t l2_miss;
-		uint64_t l2_hits;
-		uint64_t l3_miss;
-		uint64_t l3_hits;
-		#if (__amd64__) && (USE_PCM)
-		core_counter_state_ptr_t counter_state;
-		#endif
-	public :
-		ROICounter(int32_t lproc_id) :
-			#if (__amd64__) && (USE_PCM)
-			counter_state(NULL),
-			#endif
-			lproc_id(lproc_id),
-			tsc(0),
-			instret(0),
-			cpu_cycles(0),
-			l1d_hits(0),
-			l1d_miss(0),
-			l2_hits(0),
-			l2_miss(0),
-			l3_hits(0),
-			l3_miss(0) {}
-			
-		void mark_roi();
-		void start_roi();
-		void stop_roi();
-		ROICounter & operator - (const ROICounter & o);
-};
-
-ROICounter & ROICounter::operator - (const ROICounter & o) {
-	#if (__amd64__) && (USE_PCM)
-	struct __eco_roi_stats_struct  tmp = __eco_counter_diff(counter_state, o.counter_state);
-	tsc = tmp.tsc;
-	instret = tmp.instret;
-	cpu_cycles = tmp.cpu_cycles;
-	l1d_miss = tmp.l1d_miss;
-	l1d_hits = tmp.l1d_hits;
-	l2_miss = tmp.l2_miss;
-	l2_hits = tmp.l2_hits;
-	l3_miss = tmp.l3_miss;
-	l3_hits = tmp.l3_hits;
-	#else
-	tsc = this->tsc - o.tsc;
-	instret = 0;
-	cpu_cycles = 0;
-	l1d_miss = 0;
-	l1d_hits = 0;
-	l2_miss = 0;
-	l2_hits = 0;
-	l3_miss = 0;
-	l3_hits = 0;
-	#endif
+static bool parseList(const char *arg, std::vector<long> *out) {
+	out->clear();
+	for (const char *p = arg; ; p++) {
+		char *end;
+		long v = strtol(p, &end, 10);
+		if (end == p || v < 0)
+			return false;
+		out->push_back(v);
+		p = end;
+		if (*p == '\0')
+			return true;
+		if (*p != ',')
+			return false;
+	}
 }
 
-void ROICounter::mark_roi() {
-	#if (__amd64__) && (USE_PCM)
-   	counter_state = __eco_roi_begin(lproc_id);
-   	#endif
-	#ifdef GEM5_RV64
-	tsc = -1;
-	#else
-	tsc = __eco_rdtsc();
-	#endif
-	instret = -1;
-	cpu_cycles = -1;
-	l1d_miss = -1;
-	l1d_hits = -1;
-	l2_miss = -1;
-	l2_hits = -1;
-	l3_miss = -1;
-	l3_hits = -1;
+/* "N" elements or "NB" bytes, in bytes; whole elements only, as band_alloc() requires */
+static bool parseOffset(const char *p, char **end, size_t *bytes) {
+	long v = strtol(p, end, 10);
+	if (*end == p || v < 0)
+		return false;
+	*bytes = (size_t)v;
+	if (**end == 'b' || **end == 'B')
+		(*end)++;
+	else
+		*bytes *= sizeof(STREAM_TYPE);
+	if (*bytes % sizeof(STREAM_TYPE) != 0) {
+		fprintf(stderr, "array offsets must be multiples of %zu bytes\n", sizeof(STREAM_TYPE));
+		return false;
+	}
+	return true;
 }
 
-void ROICounter::start_roi() {
-	#ifdef GEM5_RV64
-	m5_reset_stats(0,0);
-	#endif
-	mark_roi();
+/* "A,B,C" per array, or "K" for a, b, c at 0, K, 2K */
+static bool parseOffsets(const char *arg, size_t offsets[3]) {
+	char *end;
+	int n = 0;
+	for (const char *p = arg; n < 3; p = end + 1) {
+		if (!parseOffset(p, &end, &offsets[n]))
+			return false;
+		n++;
+		if (*end == '\0')
+			break;
+		if (*end != ',')
+			return false;
+	}
+	if (n == 1) {
+		offsets[2] = 2 * offsets[0];
+		offsets[1] = offsets[0];
+		offsets[0] = 0;
+	}
+	return *end == '\0' && (n == 1 || n == 3);
 }
 
+/* Comma-separated staggers for --offset-sweep */
+static bool parseOffsetList(const char *arg, std::vector<size_t> *out) {
+	char *end;
+	out->clear();
+	for (const char *p = arg; ; p = end + 1) {
+		size_t bytes;
+		if (!parseOffset(p, &end, &bytes))
+			return false;
+		out->push_back(bytes);
+		if (*end == '\0')
+			return true;
+		if (*end != ',')
+			return false;
+	}
+}
 
-void ROICounter::stop_roi() {
-	#ifdef GEM5_RV64
-	 m5_dump_stats(0,0);
-	#endif
-	mark_roi();
+/* Bytes, with an optional k/K or m/M suffix */
+static bool parseAlign(const char *arg, size_t *out) {
+	char *end;
+	long v = strtol(arg, &end, 10);
+	if (end == arg || v < 0)
+		return false;
+	*out = (size_t)v;
+	if (*end == 'k' || *end == 'K')
+		*out <<= 10, end++;
+	else if (*end == 'm' || *end == 'M')
+		*out <<= 20, end++;
+	return *end == '\0';
+}
+
+static void usage(const char *prog) {
+	fprintf(stderr, "usage: %s [options] num_elements\n", prog);
+	fprintf(stderr, "       %s [options] --baseline=FILE [num_elements]\n", prog);
+	fprintf(stderr, "  -s, --samples=FILE   write every per-iteration kernel time to FILE (CSV)\n");
+	fprintf(stderr, "  -j, --json=FILE      write the full result as JSON to FILE ('-' for stdout)\n");
+	fprintf(stderr, "  -c, --csv=FILE       write the full result as CSV to FILE ('-' for stdout; the\n");
+	fprintf(stderr, "                       text report then goes to stderr)\n");
+	fprintf(stderr, "  -b, --baseline=FILE  compare against a previous --json result; exit %d on regression\n", EXIT_REGRESSION);
+	fprintf(stderr, "                       (reruns its iterations, kernel variant, extra kernels, stride,\n");
+	fprintf(stderr, "                       prefetch, placement, alignment, offsets and threads unless given)\n");
+	fprintf(stderr, "  -t, --threshold=PCT  median bandwidth drop that counts as a regression (default %.1f)\n", BASELINE_THRESHOLD_PCT);
+	fprintf(stderr, "  -a, --alpha=P        significance level of the per-kernel test (default %.2f)\n", BASELINE_ALPHA);
+	fprintf(stderr, "  -T, --timer=SOURCE   auto, tsc, cntvct, rdtime, rdcycle or clock (default auto)\n");
+	fprintf(stderr, "  -r, --roi=MODE       'loop' (one ROI around all iterations, default) or 'kernel'\n");
+	fprintf(stderr, "                       (reset/dump stats around every kernel invocation;\n");
+	fprintf(stderr, "                       per-kernel energy and frequency need 'kernel')\n");
+	fprintf(stderr, "  -i, --roi-iteration=K  with --roi=kernel, only bracket iteration K\n");
+	fprintf(stderr, "  -k, --kernels=VARIANT  kernel implementation to run ('list' to show all)\n");
+	fprintf(stderr, "  -S, --stride=N       element stride of the strided variants (default %zd)\n", kernel_params.stride);
+	fprintf(stderr, "  -P, --prefetch=LINES software prefetch distance in %d-byte lines for the variants\n", CACHE_LINE_BYTES);
+	fprintf(stderr, "                       that issue explicit prefetches (default 0 = none)\n");
+	fprintf(stderr, "  -p, --prefetch-sweep=LIST  repeat the run for every distance in LIST (e.g.\n");
+	fprintf(stderr, "                       0,1,2,4,8,16,32) and tabulate bandwidth and LLC misses;\n");
+	fprintf(stderr, "                       selects the 'prefetch' variant unless -k names another\n");
+	fprintf(stderr, "  -L, --prefetch-locality=N  locality hint 0..3 of the 'prefetch' variant\n");
+	fprintf(stderr, "                       (0 = non-temporal, 3 = keep in all levels; default 0)\n");
+	fprintf(stderr, "  -W, --no-prefetch-write  'prefetch' variant: only prefetch the loaded streams\n");
+	fprintf(stderr, "  -R, --roofline       run the Triad stream at every compiled-in FMA intensity\n");
+	fprintf(stderr, "                       (ROOFLINE_POINTS) and fit the roofline instead of STREAM\n");
+	fprintf(stderr, "  -F, --fused[=KIB]    after the normal run, repeat it with the four kernels fused\n");
+	fprintf(stderr, "                       over blocks of KIB KiB per array (default %d) and compare\n", FUSED_BLOCK_KIB);
+	fprintf(stderr, "  -I, --sample-interval=US  record completed bytes every US microseconds from a\n");
+	fprintf(stderr, "                       monitor thread and report the bandwidth over time\n");
+	fprintf(stderr, "                       (default %d when only --trace is given)\n", SAMPLER_INTERVAL_US);
+	fprintf(stderr, "  -M, --sample-cpu=N   CPU for the monitor thread (default: the last CPU we may use\n");
+	fprintf(stderr, "                       if the OpenMP team leaves it free, else unpinned)\n");
+	fprintf(stderr, "  -o, --trace=FILE     write the bandwidth-over-time trace to FILE (CSV, '-' for stdout)\n");
+	fprintf(stderr, "  -X, --interference=PATTERN  noisy-neighbour mode: rerun the kernels with 0, 1, ...\n");
+	fprintf(stderr, "                       aggressors running 'triad', 'random' or 'thrash' on\n");
+	fprintf(stderr, "                       their own buffers, reporting victim bandwidth and latency\n");
+	fprintf(stderr, "  -A, --aggressor-cpus=LIST  CPUs of the aggressors, in activation order (e.g. 4,5,6,7)\n");
+	fprintf(stderr, "                       (the victim team runs, one thread per CPU, on the others)\n");
+	fprintf(stderr, "  -m, --aggressor-mib=N  buffer per aggressor in MiB (default %d)\n", INTERFERENCE_AGGRESSOR_MIB);
+	fprintf(stderr, "  -H, --ping-pong[=LIST]  measure the cache-line round trip between every pair of\n");
+	fprintf(stderr, "                       CPUs in LIST (default: all we may use) instead of STREAM;\n");
+	fprintf(stderr, "                       num_elements is not needed\n");
+	fprintf(stderr, "  -O, --ping-pong-op=OP  handoff by 'store' (default) or 'cas'\n");
+	fprintf(stderr, "  -u, --atomics[=LIST] time fetch-add, CAS and exchange on a shared line, padded\n");
+	fprintf(stderr, "                       lines and a falsely shared line at every thread count in\n");
+	fprintf(stderr, "                       LIST (default 1, 2, 4, ... OpenMP threads) instead of STREAM\n");
+	fprintf(stderr, "  -g, --ring[=PAIRS]   stream %d-byte messages through an SPSC ring between the\n", CACHE_LINE_BYTES);
+	fprintf(stderr, "                       producer:consumer CPU PAIRS (e.g. 0:1,0:8; default one pair\n");
+	fprintf(stderr, "                       per topology class) instead of STREAM\n");
+	fprintf(stderr, "  -w, --file-io=DIR    after the normal run, stream array a to a scratch file in DIR\n");
+	fprintf(stderr, "                       and back (buffered, O_DIRECT, io_uring) and compare with Copy\n");
+	fprintf(stderr, "  -B, --io-block=KIB   bytes per I/O in KiB, a multiple of %d (default %d)\n", IO_ALIGN / 1024, IO_BLOCK_KIB);
+	fprintf(stderr, "  -Q, --io-depth=N     io_uring I/Os in flight (default %d)\n", IO_DEPTH);
+	fprintf(stderr, "  -y, --memcpy[=MIB]   compare memcpy implementations (libc, rep movsb, AVX2,\n");
+	fprintf(stderr, "                       AVX-512, non-temporal, parallel, the -k Copy kernel) at\n");
+	fprintf(stderr, "                       every size from %d B to MIB MiB (default %d) instead of STREAM\n",
+		MEMCPY_MIN_BYTES, MEMCPY_MAX_MIB);
+	fprintf(stderr, "  -f, --faults[=MIB]   time first touch of fresh MIB-sized mappings (default %d)\n", FAULT_MIB);
+	fprintf(stderr, "                       with 4K pages, THP, MAP_POPULATE and MADV_POPULATE_WRITE,\n");
+	fprintf(stderr, "                       single-threaded and parallel, instead of STREAM\n");
+	fprintf(stderr, "  -l, --placement=P   'malloc' (pages faulted in by the initializing thread,\n");
+	fprintf(stderr, "                       default), 'first-touch' (each thread faults its own chunk),\n");
+	fprintf(stderr, "                       or mmap of 'anon' memory, a 'tmpfs' file in %s or a\n", BAND_TMPFS_DIR);
+	fprintf(stderr, "                       page cache 'file'; add '+populate' for MAP_POPULATE\n");
+	fprintf(stderr, "  -z, --align=BYTES    start every array on a BYTES boundary, e.g. 64, 4k or 2m\n");
+	fprintf(stderr, "                       (default: wherever the allocator puts it)\n");
+	fprintf(stderr, "  -E, --offsets=A,B,C  place a, b, c that many elements past their aligned bases\n");
+	fprintf(stderr, "                       ('B' suffix: bytes); a single K means 0,K,2K (default %d)\n", OFFSET);
+	fprintf(stderr, "  -Z, --offset-sweep=LIST  repeat the run for every stagger K in LIST (e.g.\n");
+	fprintf(stderr, "                       0,8,64,512b,4096b) with a, b, c at 0, K, 2K past bases\n");
+	fprintf(stderr, "                       aligned to --align (default 2m) and tabulate bandwidth\n");
+	fprintf(stderr, "  -D, --map-dir=DIR    directory of the 'file' placement (default $TMPDIR or %s)\n", BAND_FILE_DIR);
+	fprintf(stderr, "  -e, --extra-kernels=LIST  also time these registry kernels after Copy, Scale, Add\n");
+	fprintf(stderr, "                       and Triad (e.g. rowdecode,checksum; 'list' to show all)\n");
+	fprintf(stderr, "  -n, --iterations=N   run N iterations instead of NTIMES=%d (2 <= N <= NTIMES)\n", NTIMES);
+	fprintf(stderr, "  -C, --checkpoint     GEM5_RV64: m5_checkpoint after allocation and initialization\n");
+	fprintf(stderr, "  -x, --exit-after-roi GEM5_RV64: m5_exit as soon as the ROI ends (no report/validation)\n");
+	fprintf(stderr, "  -h, --help           print this message\n");
 }
 
 int main(int argc, char* argv[]) {
     int			bytesPerWord;
-    int			k;
-    ssize_t		j;
-    STREAM_TYPE		scalar;
-    double		t, times[4][NTIMES];
+    BandConfig		cfg;
+    const char		*samples_path = NULL;
+    const char		*json_path = NULL;
+    const char		*csv_path = NULL;
+    const char		*baseline_path = NULL;
+    double		threshold_pct = BASELINE_THRESHOLD_PCT;
+    double		alpha = BASELINE_ALPHA;
+    RunResult		baseline;
+    TimerSource		timer_source = TIMER_AUTO;
+    RoiMode		roi_mode = ROI_LOOP;
+    int			roi_iteration = -1;
+    int			ntimes = NTIMES;
+    bool		checkpoint = false;
+    bool		exit_after_roi = false;
+    const KernelSet	*ks = kernel_set_default();
+    std::vector<long>	sweep;
+    std::vector<size_t>	offset_sweep;		/* bytes of stagger per point */
+    bool		roofline = false;
+    ssize_t		fused_block = 0;	/* elements, 0 = unfused only */
+    long		sample_interval = 0;	/* us, 0 = no sampling */
+    int			sample_cpu = -1;
+    const char		*trace_path = NULL;
+    bool		interference = false;
+    InterferenceConfig	icfg;
+    bool		pingpong = false;
+    PingPongOp		pingpong_op = PINGPONG_STORE;
+    std::vector<long>	pingpong_cpus;
+    bool		atomics = false;
+    std::vector<long>	atomic_threads;
+    bool		ring = false;
+    long		fault_mib = 0;		/* 0 = no first-touch mode */
+    long		memcpy_mib = 0;		/* 0 = no memcpy shoot-out */
+    IoConfig		io;			/* empty dir = no file I/O */
+    int			io_errors = 0;
+    std::vector<RingPair> ring_pairs;
+
+    io.block = (size_t)IO_BLOCK_KIB << 10;
+    io.depth = IO_DEPTH;
+    icfg.pattern = AGGRESSOR_TRIAD;
+    icfg.aggressor_bytes = (size_t)INTERFERENCE_AGGRESSOR_MIB << 20;
+    icfg.latency_bytes = (size_t)INTERFERENCE_LATENCY_MIB << 20;
 
 	/* --- SETUP --- */
     fprintf(stderr,HLINE);
@@ -309,19 +487,582 @@ int main(int argc, char* argv[]) {
     fprintf(stderr,"This system uses %d bytes per array element.\n",
 	bytesPerWord);
     fprintf(stderr,HLINE);
-	if (argc != 4) {
+	static struct option long_options[] = {
+		{"samples", required_argument, 0, 's'},
+		{"json",    required_argument, 0, 'j'},
+		{"csv",     required_argument, 0, 'c'},
+		{"baseline",  required_argument, 0, 'b'},
+		{"threshold", required_argument, 0, 't'},
+		{"alpha",     required_argument, 0, 'a'},
+		{"timer",     required_argument, 0, 'T'},
+		{"roi",       required_argument, 0, 'r'},
+		{"roi-iteration", required_argument, 0, 'i'},
+		{"iterations",    required_argument, 0, 'n'},
+		{"checkpoint",    no_argument,       0, 'C'},
+		{"exit-after-roi", no_argument,      0, 'x'},
+		{"kernels",       required_argument, 0, 'k'},
+		{"stride",        required_argument, 0, 'S'},
+		{"prefetch",      required_argument, 0, 'P'},
+		{"prefetch-sweep",    required_argument, 0, 'p'},
+		{"prefetch-locality", required_argument, 0, 'L'},
+		{"no-prefetch-write", no_argument,       0, 'W'},
+		{"roofline",      no_argument,       0, 'R'},
+		{"fused",         optional_argument, 0, 'F'},
+		{"sample-interval", required_argument, 0, 'I'},
+		{"sample-cpu",    required_argument, 0, 'M'},
+		{"trace",         required_argument, 0, 'o'},
+		{"interference",  required_argument, 0, 'X'},
+		{"aggressor-cpus", required_argument, 0, 'A'},
+		{"aggressor-mib", required_argument, 0, 'm'},
+		{"ping-pong",     optional_argument, 0, 'H'},
+		{"ping-pong-op",  required_argument, 0, 'O'},
+		{"atomics",       optional_argument, 0, 'u'},
+		{"ring",          optional_argument, 0, 'g'},
+		{"faults",        optional_argument, 0, 'f'},
+		{"memcpy",        optional_argument, 0, 'y'},
+		{"file-io",       required_argument, 0, 'w'},
+		{"io-block",      required_argument, 0, 'B'},
+		{"io-depth",      required_argument, 0, 'Q'},
+		{"placement",     required_argument, 0, 'l'},
+		{"map-dir",       required_argument, 0, 'D'},
+		{"align",         required_argument, 0, 'z'},
+		{"offsets",       required_argument, 0, 'E'},
+		{"offset-sweep",  required_argument, 0, 'Z'},
+		{"extra-kernels", required_argument, 0, 'e'},
+		{"help",    no_argument,       0, 'h'},
+		{0, 0, 0, 0}
+	};
+	int opt;
+	bool given[128] = { false };	/* options on the command line, by short name */
+	while ((opt = getopt_long(argc, argv, "s:j:c:b:t:a:T:r:i:n:Cxk:S:P:p:L:WRF::I:M:o:X:A:m:H::O:u::g::f::y::w:B:Q:l:D:z:E:Z:e:h", long_options, NULL)) != -1) {
+		if (opt > 0 && opt < 128)
+			given[opt] = true;
+		switch (opt) {
+		case 's':
+			samples_path = optarg;
+			break;
+		case 'j':
+			json_path = optarg;
+			break;
+		case 'c':
+			csv_path = optarg;
+			break;
+		case 'b':
+			baseline_path = optarg;
+			break;
+		case 't':
+			threshold_pct = atof(optarg);
+			break;
+		case 'a':
+			alpha = atof(optarg);
+			break;
+		case 'T':
+			if (!timer_parse_source(optarg, &timer_source)) {
+				fprintf(stderr, "Unknown timer source '%s'\n", optarg);
+				return 1;
+			}
+			break;
+		case 'r':
+			if (strcmp(optarg, "loop") == 0)
+				roi_mode = ROI_LOOP;
+			else if (strcmp(optarg, "kernel") == 0)
+				roi_mode = ROI_KERNEL;
+			else {
+				fprintf(stderr, "Unknown ROI mode '%s'\n", optarg);
+				return 1;
+			}
+			break;
+		case 'i':
+			roi_iteration = atoi(optarg);
+			break;
+		case 'n':
+			ntimes = atoi(optarg);
+			if (ntimes < 2 || ntimes > NTIMES) {
+				fprintf(stderr, "Iterations must be in [2, %d]\n", NTIMES);
+				return 1;
+			}
+			break;
+		case 'C':
+			checkpoint = true;
+			break;
+		case 'x':
+			exit_after_roi = true;
+			break;
+		case 'k':
+			if (strcmp(optarg, "list") == 0) {
+				kernel_set_list(stdout);
+				return 0;
+			}
+			ks = kernel_set_find(optarg);
+			if (ks == NULL) {
+				fprintf(stderr, "Unknown kernel variant '%s'; available:\n", optarg);
+				kernel_set_list(stderr);
+				return 1;
+			}
+			if (!ks->available()) {
+				fprintf(stderr, "Kernel variant '%s' is not supported by this build or CPU\n", optarg);
+				return 1;
+			}
+			break;
+		case 'S':
+			kernel_params.stride = atol(optarg);
+			if (kernel_params.stride < 1) {
+				fprintf(stderr, "Stride must be at least 1\n");
+				return 1;
+			}
+			break;
+		case 'P':
+			kernel_params.prefetch_lines = atol(optarg);
+			if (kernel_params.prefetch_lines < 0) {
+				fprintf(stderr, "Prefetch distance must not be negative\n");
+				return 1;
+			}
+			break;
+		case 'p':
+			if (!parseList(optarg, &sweep)) {
+				fprintf(stderr, "Bad prefetch sweep '%s'; expected e.g. 0,1,2,4,8\n", optarg);
+				return 1;
+			}
+			break;
+		case 'L':
+			kernel_params.prefetch_locality = atoi(optarg);
+			if (kernel_params.prefetch_locality < 0 || kernel_params.prefetch_locality > 3) {
+				fprintf(stderr, "Prefetch locality must be in [0, 3]\n");
+				return 1;
+			}
+			break;
+		case 'W':
+			kernel_params.prefetch_write = false;
+			break;
+		case 'R':
+			roofline = true;
+			break;
+		case 'F': {
+			long kib = optarg ? atol(optarg) : FUSED_BLOCK_KIB;
+			if (kib < 1) {
+				fprintf(stderr, "Fused block size must be at least 1 KiB\n");
+				return 1;
+			}
+			/* Whole cache lines, so blocks never share a line */
+			fused_block = kib * 1024 / CACHE_LINE_BYTES * (CACHE_LINE_BYTES / sizeof(STREAM_TYPE));
+			break;
+		}
+		case 'I':
+			sample_interval = atol(optarg);
+			if (sample_interval < 1) {
+				fprintf(stderr, "Sample interval must be at least 1 us\n");
+				return 1;
+			}
+			break;
+		case 'M':
+			sample_cpu = atoi(optarg);
+			break;
+		case 'o':
+			trace_path = optarg;
+			break;
+		case 'X':
+			if (!interference_parse_pattern(optarg, &icfg.pattern)) {
+				fprintf(stderr, "Unknown aggressor pattern '%s' (triad, random or thrash)\n", optarg);
+				return 1;
+			}
+			interference = true;
+			break;
+		case 'A':
+			if (!parseList(optarg, &icfg.cpus)) {
+				fprintf(stderr, "Bad CPU list '%s'; expected e.g. 4,5,6,7\n", optarg);
+				return 1;
+			}
+			break;
+		case 'm':
+			if (atol(optarg) < 1) {
+				fprintf(stderr, "Aggressor buffers must be at least 1 MiB\n");
+				return 1;
+			}
+			icfg.aggressor_bytes = (size_t)atol(optarg) << 20;
+			break;
+		case 'H':
+			if (optarg != NULL && !parseList(optarg, &pingpong_cpus)) {
+				fprintf(stderr, "Bad CPU list '%s'; expected e.g. 0,1,8,9\n", optarg);
+				return 1;
+			}
+			pingpong = true;
+			break;
+		case 'O':
+			if (!pingpong_parse_op(optarg, &pingpong_op)) {
+				fprintf(stderr, "Unknown ping-pong handoff '%s' (store or cas)\n", optarg);
+				return 1;
+			}
+			break;
+		case 'u':
+			if (optarg != NULL && !parseList(optarg, &atomic_threads)) {
+				fprintf(stderr, "Bad thread count list '%s'; expected e.g. 1,2,4,8\n", optarg);
+				return 1;
+			}
+			for (size_t t = 0; t < atomic_threads.size(); t++)
+				if (atomic_threads[t] < 1) {
+					fprintf(stderr, "Thread counts must be at least 1\n");
+					return 1;
+				}
+			atomics = true;
+			break;
+		case 'g':
+			if (optarg != NULL && !ring_parse_pairs(optarg, &ring_pairs)) {
+				fprintf(stderr, "Bad CPU pair list '%s'; expected e.g. 0:1,0:8\n", optarg);
+				return 1;
+			}
+			ring = true;
+			break;
+		case 'f':
+			fault_mib = optarg ? atol(optarg) : FAULT_MIB;
+			if (fault_mib < 1) {
+				fprintf(stderr, "First-touch mappings must be at least 1 MiB\n");
+				return 1;
+			}
+			break;
+		case 'y':
+			memcpy_mib = optarg ? atol(optarg) : MEMCPY_MAX_MIB;
+			if (memcpy_mib < 1) {
+				fprintf(stderr, "The largest memcpy size must be at least 1 MiB\n");
+				return 1;
+			}
+			break;
+		case 'w':
+			io.dir = optarg;
+			break;
+		case 'B':
+			io.block = (size_t)atol(optarg) << 10;
+			if (io.block == 0 || io.block % IO_ALIGN != 0) {
+				fprintf(stderr, "I/O blocks must be a positive multiple of %d KiB\n", IO_ALIGN / 1024);
+				return 1;
+			}
+			break;
+		case 'Q':
+			io.depth = atoi(optarg);
+			if (io.depth < 1 || io.depth > 4096) {
+				fprintf(stderr, "I/O depth must be in [1, 4096]\n");
+				return 1;
+			}
+			break;
+		case 'l':
+			if (!band_parse_placement(optarg, &cfg.placement, &cfg.populate)) {
+				fprintf(stderr, "Unknown placement '%s' (malloc, first-touch, anon, tmpfs or file;\n"
+					"the last three may end in +populate)\n", optarg);
+				return 1;
+			}
+			break;
+		case 'D':
+			cfg.map_dir = optarg;
+			break;
+		case 'z':
+			if (!parseAlign(optarg, &cfg.align) || cfg.align < sizeof(void *) ||
+			    (cfg.align & (cfg.align - 1)) != 0) {
+				fprintf(stderr, "Bad alignment '%s'; expected a power of two of at least %zu, e.g. 64, 4k, 2m\n",
+					optarg, sizeof(void *));
+				return 1;
+			}
+			break;
+		case 'E':
+			if (!parseOffsets(optarg, cfg.offsets)) {
+				fprintf(stderr, "Bad offsets '%s'; expected A,B,C or K in elements, e.g. 0,8,16 or 64b\n", optarg);
+				return 1;
+			}
+			break;
+		case 'Z':
+			if (!parseOffsetList(optarg, &offset_sweep)) {
+				fprintf(stderr, "Bad offset sweep '%s'; expected e.g. 0,8,64,4096b\n", optarg);
+				return 1;
+			}
+			break;
+		case 'e':
+			if (strcmp(optarg, "list") == 0) {
+				registry_list(stdout);
+				return 0;
+			}
+			if (!parseKernels(optarg, &cfg.extra))
+				return 1;
+			break;
+		case 'h':
+			usage(argv[0]);
+			return 0;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+	if (roi_iteration >= ntimes) {
+		fprintf(stderr, "ROI iteration must be in [0, %d)\n", ntimes);
+		return 1;
+	}
+	/* Structured output on stdout cannot share it with the report or each other */
+	int to_stdout = 0;
+	const char *outputs[] = { json_path, csv_path, samples_path, trace_path };
+	for (size_t i = 0; i < sizeof(outputs) / sizeof(outputs[0]); i++)
+		to_stdout += outputs[i] != NULL && strcmp(outputs[i], "-") == 0;
+	if (to_stdout > 1) {
+		fprintf(stderr, "Only one of --json, --csv, --samples and --trace can write to '-'\n");
+		return 1;
+	}
+	if (to_stdout == 1 && result_claim_stdout() != 0) {
+		fprintf(stderr, "Cannot redirect the report to stderr: %s\n", strerror(errno));
+		return 1;
+	}
+	#ifndef GEM5_RV64
+	if (checkpoint || exit_after_roi)
+		fprintf(stderr, "WARNING: --checkpoint/--exit-after-roi only apply to the GEM5_RV64 build; ignored\n");
+	#endif
+	/* Every mode replaces the plain timed run, so at most one of them */
+	int modes = roofline + interference + (fused_block > 0) + !sweep.empty() + !offset_sweep.empty() +
+	            pingpong + atomics + ring + (fault_mib > 0) + (memcpy_mib > 0);
+	if (modes > 1) {
+		fprintf(stderr, "Only one of --roofline, --interference, --fused, --prefetch-sweep, --offset-sweep,\n"
+		                "--ping-pong, --atomics, --ring, --faults and --memcpy may be given\n");
+		return 1;
+	}
+	/* A baseline compares STREAM bandwidth, fused or not */
+	if (baseline_path != NULL && modes > (fused_block > 0)) {
+		fprintf(stderr, "--baseline can only be combined with --fused\n");
+		return 1;
+	}
+	if (interference && icfg.cpus.empty()) {
+		fprintf(stderr, "--interference needs --aggressor-cpus\n");
+		return 1;
+	}
+	if (pingpong) {
+		if (pingpong_cpus.empty())
+			pingpong_default_cpus(&pingpong_cpus);
+		/* Two spinning threads on one CPU would only measure the scheduler */
+		std::vector<long> sorted = pingpong_cpus;
+		std::sort(sorted.begin(), sorted.end());
+		if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) {
+			fprintf(stderr, "--ping-pong CPUs must be distinct\n");
+			return 1;
+		}
+		if (pingpong_cpus.size() < 2) {
+			fprintf(stderr, "--ping-pong needs at least two CPUs\n");
+			return 1;
+		}
+	}
+	if (atomics) {
+		/* Every point must run with exactly its team size */
+		#ifdef _OPENMP
+		omp_set_dynamic(0);
+		int limit = omp_get_thread_limit();
+		int workers = omp_get_max_threads() < limit ? omp_get_max_threads() : limit;
+		#else
+		int limit = 1, workers = 1;
+		#endif
+		if (atomic_threads.empty())
+			atomic_default_threads(workers, &atomic_threads);
+		for (size_t t = 0; t < atomic_threads.size(); t++)
+			if (atomic_threads[t] > limit) {
+				fprintf(stderr, "--atomics thread count %ld exceeds the OpenMP thread limit %d\n",
+					atomic_threads[t], limit);
+				return 1;
+			}
+	}
+	if (ring) {
+		if (ring_pairs.empty())
+			ring_default_pairs(&ring_pairs);
+		if (ring_pairs.empty()) {
+			fprintf(stderr, "--ring needs at least two CPUs\n");
+			return 1;
+		}
+		for (size_t p = 0; p < ring_pairs.size(); p++)
+			if (ring_pairs[p].producer == ring_pairs[p].consumer) {
+				fprintf(stderr, "--ring producer and consumer must be on different CPUs\n");
+				return 1;
+			}
+	}
+	if (!io.dir.empty() && (roofline || interference || !sweep.empty() || !offset_sweep.empty())) {
+		fprintf(stderr, "--file-io cannot be combined with --roofline, --interference or either sweep\n");
+		return 1;
+	}
+	/* Rather than after the whole run */
+	if (!io.dir.empty() && access(io.dir.c_str(), W_OK) != 0) {
+		fprintf(stderr, "--file-io directory %s: %s\n", io.dir.c_str(), strerror(errno));
+		return 1;
+	}
+	/* Those modes only know the STREAM four */
+	if (!cfg.extra.empty() && (roofline || fused_block > 0)) {
+		fprintf(stderr, "--extra-kernels cannot be combined with --roofline or --fused\n");
+		return 1;
+	}
+	if (!offset_sweep.empty()) {
+		/* Same base for all three, so only the stagger moves them relative to each other */
+		if (cfg.align == 0)
+			cfg.align = OFFSET_SWEEP_ALIGN;
+		for (int i = 0; i < 3; i++)
+			cfg.offsets[i] = i * offset_sweep[0];
+	}
+	if (!sweep.empty()) {
+		/* The reference loops ignore the distance; sweep the prefetching copy of them */
+		if (ks == kernel_set_default())
+			ks = &kernel_set_prefetch;
+	}
+	if (baseline_path != NULL) {
+		std::string err;
+		if (load_result_json(baseline_path, &baseline, &err) != 0) {
+			fprintf(stderr, "Cannot load baseline %s: %s\n", baseline_path, err.c_str());
+			return 1;
+		}
+		/* Re-run its configuration wherever the command line leaves it open */
+		const RunConfig &bc = baseline.config;
+		if (!given['n'] && bc.ntimes != 0) {
+			if (bc.ntimes < 2 || bc.ntimes > NTIMES) {
+				fprintf(stderr, "Baseline ntimes %d is not in [2, %d]; pass --iterations\n", bc.ntimes, NTIMES);
+				return 1;
+			}
+			ntimes = bc.ntimes;
+		}
+		if (!given['k'] && !bc.kernel_variant.empty()) {
+			ks = kernel_set_find(bc.kernel_variant.c_str());
+			if (ks == NULL || !ks->available()) {
+				fprintf(stderr, "Baseline kernel variant '%s' is not available here; pass --kernels\n",
+					bc.kernel_variant.c_str());
+				return 1;
+			}
+		}
+		/* --fused only knows the STREAM four; the gate warns about the rest */
+		if (!given['e'] && fused_block == 0) {
+			cfg.extra.clear();
+			for (size_t i = 0; i < bc.extra_kernels.size(); i++) {
+				const StreamKernel *k = registry_find(bc.extra_kernels[i].c_str());
+				if (k == NULL) {
+					fprintf(stderr, "Baseline kernel '%s' is not in this build; pass --extra-kernels\n",
+						bc.extra_kernels[i].c_str());
+					return 1;
+				}
+				cfg.extra.push_back(k);
+			}
+		}
+		if (!given['S'] && bc.stride > 0)
+			kernel_params.stride = bc.stride;
+		if (!given['P'])
+			kernel_params.prefetch_lines = bc.prefetch_lines;
+		if (!given['l'] && !bc.placement.empty() &&
+		    !band_parse_placement(bc.placement.c_str(), &cfg.placement, &cfg.populate)) {
+			fprintf(stderr, "Baseline placement '%s' is unknown; pass --placement\n", bc.placement.c_str());
+			return 1;
+		}
+		if (!given['z'])
+			cfg.align = bc.align;
+		if (!given['E'])
+			for (int i = 0; i < 3; i++)
+				cfg.offsets[i] = bc.offsets[i];
+		/* OMP_NUM_THREADS is how threads are chosen explicitly */
+		#ifdef _OPENMP
+		if (bc.threads > 0 && getenv("OMP_NUM_THREADS") == NULL)
+			omp_set_num_threads(bc.threads);
+		#endif
+		if (roi_iteration >= ntimes) {
+			fprintf(stderr, "ROI iteration must be in [0, %d)\n", ntimes);
+			return 1;
+		}
+	}
+	/* Trailing positional arguments after num_elements are accepted and ignored */
+	if (optind >= argc && baseline_path == NULL && !pingpong && !atomics && !ring && fault_mib == 0 && memcpy_mib == 0) {
       fprintf(stderr, "argc=%d\n", argc);
-      fprintf(stderr, "");
+      usage(argv[0]);
       return 1;
    	}
-	uint32_t num_elements = atoi(argv[1]);
+	/* With a baseline, re-run its configuration unless told otherwise */
+	uint32_t num_elements = (optind < argc) ? atoi(argv[optind])
+	                                        : (uint32_t)baseline.config.num_elements;
+	cfg.num_elements = num_elements;
+	cfg.ntimes = ntimes;
+	cfg.kernels = ks;
+	cfg.params = kernel_params;
+	cfg.roi_mode = roi_mode;
+	cfg.roi_iteration = roi_iteration;
+	cfg.exit_after_roi = exit_after_roi;
 
 	/* --- Affine CPUs --- */
 	int32_t lproc_id = 0; // Logical processor ID for this thread
-	#if (__amd64__) && (USE_PCM)
-	affinity_set_cpu2(lproc_id);
-	__eco_init(lproc_id);
-	#endif
+	band_setup(lproc_id, timer_source);
+	timer_report(stderr);
+	if (energy_available()) {
+		int pkg, dram;
+		energy_domains(&pkg, &dram);
+		fprintf(stderr, "Energy: RAPL via %s, %d package and %d DRAM domains, folded every %.0f s\n",
+			energy_source(), pkg, dram, energy_poll_interval());
+	} else
+		fprintf(stderr, "Energy: no readable RAPL counters (powercap or msr)\n");
+	if (freq_available()) {
+		FreqSnapshot fs;
+		freq_read(&fs);
+		fprintf(stderr, "Frequency: %s cycles/reference cycles on %d threads, reference %.0f MHz\n",
+			freq_source(), fs.threads, 1.0E-06 * freq_ref_hz());
+	} else
+		fprintf(stderr, "Frequency: no per-thread cycle counters (perf_event or pinned msr)\n");
+
+	/* Ping-pong mode needs no arrays; the pairs run on their own pinned threads */
+	if (pingpong) {
+		PingPongMatrix matrix;
+		fprintf(stderr, "Ping-pong over %zu CPUs, %zu pairs\n",
+			pingpong_cpus.size(), pingpong_cpus.size() * (pingpong_cpus.size() - 1));
+		if (pingpong_run(pingpong_op, pingpong_cpus, &matrix) != 0) {
+			fprintf(stderr, "Ping-pong run failed\n");
+			return 1;
+		}
+		reportMode(matrix, json_path, csv_path, pingpong_print, pingpong_write_json, pingpong_write_csv);
+		return 0;
+	}
+
+	/* Atomics mode needs no arrays either; the team size varies per point */
+	if (atomics) {
+		std::vector<AtomicResult> results;
+		if (atomic_run(atomic_threads, ntimes, &results) != 0) {
+			fprintf(stderr, "Atomics run failed\n");
+			return 1;
+		}
+		reportMode(results, json_path, csv_path, atomic_print, atomic_write_json, atomic_write_csv);
+		return 0;
+	}
+
+	/* memcpy shoot-out: its own buffers at every size, no STREAM arrays */
+	if (memcpy_mib > 0) {
+		std::vector<MemcpyResult> results;
+		if (memcpy_run(ks, (size_t)memcpy_mib << 20, ntimes, &results) != 0) {
+			fprintf(stderr, "memcpy shoot-out failed\n");
+			return 1;
+		}
+		reportMode(results, json_path, csv_path, memcpy_print, memcpy_write_json, memcpy_write_csv);
+		return 0;
+	}
+
+	/* First-touch mode: fresh mappings of its own, no STREAM arrays */
+	if (fault_mib > 0) {
+		std::vector<FaultResult> results;
+		#ifdef _OPENMP
+		omp_set_dynamic(0);
+		int workers = omp_get_max_threads() < omp_get_thread_limit() ?
+			omp_get_max_threads() : omp_get_thread_limit();
+		#else
+		int workers = 1;
+		#endif
+		if (fault_run((size_t)fault_mib << 20, workers, ntimes, &results) != 0) {
+			fprintf(stderr, "First-touch run failed\n");
+			return 1;
+		}
+		reportMode(results, json_path, csv_path, fault_print, fault_write_json, fault_write_csv);
+		return 0;
+	}
+
+	/* Ring mode: message streaming between pinned thread pairs, no arrays */
+	if (ring) {
+		std::vector<RingResult> results;
+		if (ring_run(ring_pairs, ntimes, &results) != 0) {
+			fprintf(stderr, "Ring run failed\n");
+			return 1;
+		}
+		reportMode(results, json_path, csv_path, ring_print, ring_write_json, ring_write_csv);
+		for (size_t p = 0; p < results.size(); p++)
+			if (results[p].errors > 0) {
+				fprintf(stderr, "Ring messages failed verification\n");
+				return 1;
+			}
+		return 0;
+	}
 
 #ifdef N
     printf("*****  WARNING: ******\n");
@@ -331,181 +1072,428 @@ int main(int argc, char* argv[]) {
     printf("*****  WARNING: ******\n");
 #endif
 
-    fprintf(stderr,"Array size = %llu (elements), Offset = %d (elements)\n" , (unsigned long long) STREAM_ARRAY_SIZE, OFFSET);
+    fprintf(stderr,"Array size = %llu (elements), Offset = %zu, %zu, %zu (bytes)\n" , (unsigned long long) num_elements,
+	cfg.offsets[0], cfg.offsets[1], cfg.offsets[2]);
+    if (cfg.align > 0)
+        fprintf(stderr,"Array alignment = %zu bytes\n", cfg.align);
     fprintf(stderr,"Memory per array = %.1f MiB (= %.1f GiB).\n", 
-	bytesPerWord * ( (double) STREAM_ARRAY_SIZE / 1024.0/1024.0),
-	bytesPerWord * ( (double) STREAM_ARRAY_SIZE / 1024.0/1024.0/1024.0));
+	bytesPerWord * ( (double) num_elements / 1024.0/1024.0),
+	bytesPerWord * ( (double) num_elements / 1024.0/1024.0/1024.0));
     fprintf(stderr,"Total memory required = %.1f MiB (= %.1f GiB).\n",
-	(3.0 * bytesPerWord) * ( (double) STREAM_ARRAY_SIZE / 1024.0/1024.),
-	(3.0 * bytesPerWord) * ( (double) STREAM_ARRAY_SIZE / 1024.0/1024./1024.));
-    fprintf(stderr,"Each kernel will be executed %d times.\n", NTIMES);
+	(3.0 * bytesPerWord) * ( (double) num_elements / 1024.0/1024.),
+	(3.0 * bytesPerWord) * ( (double) num_elements / 1024.0/1024./1024.));
+    fprintf(stderr,"Each kernel will be executed %d times.\n", ntimes);
+    fprintf(stderr,"Kernel variant: %s (%s)\n", ks->name, ks->description);
+    if (kernel_params.prefetch_lines > 0)
+        fprintf(stderr,"Software prefetch distance: %zd lines (%zd bytes)\n",
+            kernel_params.prefetch_lines, kernel_params.prefetch_lines * CACHE_LINE_BYTES);
+    if (!offset_sweep.empty())
+        fprintf(stderr,"Offset sweep over %zu staggers\n", offset_sweep.size());
+    if (!sweep.empty())
+        fprintf(stderr,"Prefetch sweep over %zu distances, locality hint %d, write prefetch %s\n",
+            sweep.size(), kernel_params.prefetch_locality, kernel_params.prefetch_write ? "on" : "off");
     fprintf(stderr,"The *best* time for each kernel (excluding the first iteration)\n"); 
     fprintf(stderr,"will be used to compute the reported bandwidth.\n");
 
-    /* Get initial value for system clock. */
-	STREAM_TYPE *a   = (STREAM_TYPE *)malloc(num_elements * sizeof(STREAM_TYPE));
-	STREAM_TYPE *b   = (STREAM_TYPE *)malloc(num_elements * sizeof(STREAM_TYPE));
-	STREAM_TYPE *c   = (STREAM_TYPE *)malloc(num_elements * sizeof(STREAM_TYPE));
-	initializeArrays(a, num_elements);
-	initializeArrays(b, num_elements);
-	initializeArrays(c, num_elements);
+    fprintf(stderr,"Array placement: %s\n", band_placement_name(cfg.placement, cfg.populate).c_str());
+	for (size_t j = 0; j < cfg.extra.size(); j++)
+		fprintf(stderr,"Extra kernel: %s (%s), %zd %s elements of its own\n", cfg.extra[j]->name,
+			cfg.extra[j]->description, stream_kernel_elements(cfg.extra[j], num_elements), cfg.extra[j]->elem_type);
+
+	BandArrays arr;
+	std::string err;
+	if (band_alloc(cfg, &arr, &err) != 0) {
+		fprintf(stderr, "%s\n", err.c_str());
+		return 1;
+	}
+	STREAM_TYPE *a = arr.a, *b = arr.b, *c = arr.c;
+	/* What the backing costs before the first kernel runs */
+	fprintf(stderr, "Array setup: %.3f ms, %llu page faults (%.2f us/fault), %.2f GB/s\n",
+		1.0E03 * arr.setup_s, (unsigned long long)arr.setup_faults,
+		arr.setup_faults > 0 ? 1.0E06 * arr.setup_s / arr.setup_faults : 0.0,
+		1.0E-09 * 3.0 * bytesPerWord * num_elements / arr.setup_s);
     fprintf(stderr, HLINE);
+
+	/* Restore here in a detailed CPU model instead of simulating the setup */
+	#ifdef GEM5_RV64
+	if (checkpoint) {
+		fprintf(stderr, "Taking gem5 checkpoint after initialization\n");
+		m5_checkpoint(0, 0);
+	}
+	#endif
     
-    /*	--- MAIN LOOP --- repeat test cases NTIMES times --- */
-    ROICounter start(lproc_id); // CRITICAL SECTION : START
-	scalar = 3.0;
-    for (k=0; k<NTIMES; k++) {
-		#pragma omp parallel for
-		for (j=0; j<STREAM_ARRAY_SIZE; j++)
-		    c[j] = a[j];
-
-		#pragma omp parallel for
-		for (j=0; j<STREAM_ARRAY_SIZE; j++)
-		    b[j] = scalar*c[j];
-
-		#pragma omp parallel for
-		for (j=0; j<STREAM_ARRAY_SIZE; j++)
-		    c[j] = a[j]+b[j];
-
-		#pragma omp parallel for
-		for (j=0; j<STREAM_ARRAY_SIZE; j++)
-		    a[j] = b[j]+scalar*c[j];
-	}
-	ROICounter stop(lproc_id); // CRITICAL SECTION : STOP
-   
-	/* --- SUMMARY --- */
-	ROICounter diff_count = stop-start;
-
-    /* --- Check Results --- */
-    checkSTREAMresults(a,b,c,num_elements);
-    printf(HLINE);
+	/* Roofline mode replaces the four STREAM kernels altogether */
+	if (roofline) {
+		std::vector<RooflinePoint> points;
+		roofline_run(a, b, c, num_elements, ntimes, lproc_id, &points);
+		#ifdef GEM5_RV64
+		if (exit_after_roi)
+			m5_exit(0);
+		#endif
+		RooflineFit fit = roofline_fit(points, num_elements);
+		RunConfig rcfg;
+		band_describe(cfg, arr, &rcfg);
+		rcfg.kernel_variant = "roofline";
+		printf(HLINE);
+		roofline_print(stdout, points, fit, num_elements);
+		printf(HLINE);
+		if (json_path != NULL && roofline_write_json(json_path, rcfg, points, fit, num_elements) != 0)
+			fprintf(stderr, "Failed to write JSON result to %s\n", json_path);
+		if (csv_path != NULL && roofline_write_csv(csv_path, points, fit, num_elements) != 0)
+			fprintf(stderr, "Failed to write CSV result to %s\n", csv_path);
+		return 0;
+	}
 
-    return 0;
-}
+	/* Interference mode: the kernels are the victim, levels replace the timed loop */
+	if (interference) {
+		std::vector<InterferenceLevel> levels;
+		if (interference_run(icfg, cfg, &arr, &levels) != 0) {
+			fprintf(stderr, "Interference run failed\n");
+			return 1;
+		}
+		printf(HLINE);
+		interference_print(stdout, icfg, levels);
+		printf(HLINE);
+		if (json_path != NULL && interference_write_json(json_path, icfg, levels) != 0)
+			fprintf(stderr, "Failed to write JSON result to %s\n", json_path);
+		if (csv_path != NULL && interference_write_csv(csv_path, icfg, levels) != 0)
+			fprintf(stderr, "Failed to write CSV result to %s\n", csv_path);
+		return 0;
+	}
 
-# define	M	20
+	if (trace_path != NULL && sample_interval == 0)
+		sample_interval = SAMPLER_INTERVAL_US;
+	if (sample_interval > 0) {
+		#ifdef _OPENMP
+		int workers = omp_get_max_threads();
+		#else
+		int workers = 1;
+		#endif
+		if (sampler_start(sample_cpu, sample_interval, workers) != 0) {
+			fprintf(stderr, "Cannot start the bandwidth monitor thread\n");
+			return 1;
+		}
+	}
 
+	/* Sweep modes repeat the whole measurement once per prefetch distance or stagger */
+	std::vector<long> distances = sweep;
+	if (distances.empty())
+		distances.push_back(kernel_params.prefetch_lines);
+	size_t npoints = offset_sweep.empty() ? distances.size() : offset_sweep.size();
+	std::vector<RunResult> runs;
+	for (size_t point = 0; point < npoints; point++) {
+		if (point < distances.size())
+			kernel_params.prefetch_lines = cfg.params.prefetch_lines = distances[point];
+		/* checkSTREAMresults() expects exactly ntimes passes over fresh arrays */
+		if (point > 0 && !offset_sweep.empty()) {
+			band_free(&arr);
+			for (int i = 0; i < 3; i++)
+				cfg.offsets[i] = i * offset_sweep[point];
+			if (band_alloc(cfg, &arr, &err) != 0) {
+				fprintf(stderr, "%s\n", err.c_str());
+				return 1;
+			}
+		} else if (point > 0)
+			band_reset(&arr);
+		if (!sweep.empty())
+			printf("Prefetch distance: %ld lines\n", distances[point]);
+		if (!offset_sweep.empty())
+			printf("Offsets: %zu, %zu, %zu bytes\n", cfg.offsets[0], cfg.offsets[1], cfg.offsets[2]);
+		RunResult res;
+		band_measure(cfg, &arr, &res);
+		printStatistics(res);
+		if (roi_mode == ROI_KERNEL)
+			printRoiDumps(res);
+		if (energy_available())
+			printEnergy(res);
+		if (freq_available())
+			printFrequency(res);
 
-#ifndef abs
-#define abs(a) ((a) >= 0 ? (a) : -(a))
-#endif
-void checkSTREAMresults(STREAM_TYPE *a, \
-                        STREAM_TYPE *b, \
-						STREAM_TYPE *c, \
-						unsigned num_elements) {
-	STREAM_TYPE aj,bj,cj,scalar;
-	STREAM_TYPE aSumErr,bSumErr,cSumErr;
-	STREAM_TYPE aAvgErr,bAvgErr,cAvgErr;
-	double epsilon;
-	ssize_t	j;
-	int	k,ierr,err;
-
-    /* reproduce initialization */
-	aj = 1.0;
-	bj = 2.0;
-	cj = 0.0;
-    
-	/* a[] is modified during timing check */
-	aj = 2.0E0 * aj;
-    
-	/* now execute timing loop */
-	scalar = 3.0;
-	for (k=0; k<NTIMES; k++) {
-        cj = aj;
-        bj = scalar*cj;
-        cj = aj+bj;
-        aj = bj+scalar*cj;
-    }
+		/* --- Check Results --- */
+		res.validation_errors = band_validate(arr, ntimes, stdout);
+		printf(HLINE);
+		runs.push_back(res);
+	}
+	sampler_stop();
+	const RunResult &res = runs.back();
+	if (!sweep.empty() || !offset_sweep.empty()) {
+		if (!sweep.empty())
+			printPrefetchSweep(runs);
+		else
+			printOffsetSweep(runs);
+		if (samples_path != NULL)
+			fprintf(stderr, "WARNING: --samples is not written in sweep mode; use --csv\n");
+		if (json_path != NULL && write_series_file(json_path, runs, write_series_json) != 0)
+			fprintf(stderr, "Failed to write JSON result to %s\n", json_path);
+		if (csv_path != NULL && write_series_file(csv_path, runs, write_series_csv) != 0)
+			fprintf(stderr, "Failed to write CSV result to %s\n", csv_path);
+		return 0;
+	}
 
-    /* accumulate deltas between observed and expected results */
-	aSumErr = 0.0;
-	bSumErr = 0.0;
-	cSumErr = 0.0;
-	for (j=0; j<STREAM_ARRAY_SIZE; j++) {
-		aSumErr += abs(a[j] - aj);
-		bSumErr += abs(b[j] - bj);
-		cSumErr += abs(c[j] - cj);
-		// if (j == 417) printf("Index 417: c[j]: %f, cj: %f\n",c[j],cj);	// MCCALPIN
-	}
-	aAvgErr = aSumErr / (STREAM_TYPE) STREAM_ARRAY_SIZE;
-	bAvgErr = bSumErr / (STREAM_TYPE) STREAM_ARRAY_SIZE;
-	cAvgErr = cSumErr / (STREAM_TYPE) STREAM_ARRAY_SIZE;
-
-	if (sizeof(STREAM_TYPE) == 4) {
-		epsilon = 1.e-6;
-	}
-	else if (sizeof(STREAM_TYPE) == 8) {
-		epsilon = 1.e-13;
-	}
-	else {
-		printf("WEIRD: sizeof(STREAM_TYPE) = %lu\n",sizeof(STREAM_TYPE));
-		epsilon = 1.e-6;
-	}
-
-	err = 0;
-	if (abs(aAvgErr/aj) > epsilon) {
-		err++;
-		printf ("Failed Validation on array a[], AvgRelAbsErr > epsilon (%e)\n",epsilon);
-		printf ("     Expected Value: %e, AvgAbsErr: %e, AvgRelAbsErr: %e\n",aj,aAvgErr,abs(aAvgErr)/aj);
-		ierr = 0;
-		for (j=0; j<STREAM_ARRAY_SIZE; j++) {
-			if (abs(a[j]/aj-1.0) > epsilon) {
-				ierr++;
-#ifdef VERBOSE
-				if (ierr < 10) {
-					printf("         array a: index: %ld, expected: %e, observed: %e, relative error: %e\n",
-						j,aj,a[j],abs((aj-a[j])/aAvgErr));
-				}
-#endif
-			}
+	if (sample_interval > 0) {
+		std::vector<const char *> names;
+		for (size_t j = 0; j < res.kernels.size(); j++)
+			names.push_back(res.kernels[j].name.c_str());
+		sampler_print(stdout, &names[0], SAMPLER_DIP_FRACTION);
+		printf(HLINE);
+		if (trace_path != NULL && sampler_write_trace(trace_path, &names[0]) != 0)
+			fprintf(stderr, "Failed to write bandwidth trace to %s\n", trace_path);
+	}
+
+	/* Fused comparison: same kernels and iterations over fresh arrays */
+	if (fused_block > 0) {
+		FusedResult fused;
+		band_reset(&arr);
+		fused_run(ks, a, b, c, num_elements, ntimes, fused_block, BAND_SCALAR, lproc_id, &fused);
+		fused.validation_errors = band_validate(arr, ntimes, stdout);
+		fused_print(stdout, fused, res);
+		printf(HLINE);
+	}
+
+	/* File I/O last: it overwrites b */
+	if (!io.dir.empty()) {
+		std::vector<IoResult> results;
+		std::string err;
+		if (io_run(io, a, b, num_elements * sizeof(STREAM_TYPE), &results, &err) != 0) {
+			fprintf(stderr, "File I/O failed: %s\n", err.c_str());
+			return 1;
 		}
-		printf("     For array a[], %d errors were found.\n",ierr);
-	}
-	if (abs(bAvgErr/bj) > epsilon) {
-		err++;
-		printf ("Failed Validation on array b[], AvgRelAbsErr > epsilon (%e)\n",epsilon);
-		printf ("     Expected Value: %e, AvgAbsErr: %e, AvgRelAbsErr: %e\n",bj,bAvgErr,abs(bAvgErr)/bj);
-		printf ("     AvgRelAbsErr > Epsilon (%e)\n",epsilon);
-		ierr = 0;
-		for (j=0; j<STREAM_ARRAY_SIZE; j++) {
-			if (abs(b[j]/bj-1.0) > epsilon) {
-				ierr++;
-#ifdef VERBOSE
-				if (ierr < 10) {
-					printf("         array b: index: %ld, expected: %e, observed: %e, relative error: %e\n",
-						j,bj,b[j],abs((bj-b[j])/bAvgErr));
-				}
-#endif
-			}
+		io_print(stdout, io, results, 1.0E-09 * res.kernels[0].bytes / res.kernels[0].stats.median);
+		printf(HLINE);
+		for (size_t i = 0; i < results.size(); i++)
+			io_errors += results[i].errors;
+		if (io_errors > 0)
+			fprintf(stderr, "File I/O reads failed verification\n");
+	}
+
+	if (samples_path != NULL && write_result_file(samples_path, res, write_samples_csv) != 0)
+		fprintf(stderr, "Failed to write samples to %s\n", samples_path);
+	if (json_path != NULL && write_result_file(json_path, res, write_result_json) != 0)
+		fprintf(stderr, "Failed to write JSON result to %s\n", json_path);
+	if (csv_path != NULL && write_result_file(csv_path, res, write_result_csv) != 0)
+		fprintf(stderr, "Failed to write CSV result to %s\n", csv_path);
+
+	/* --- Regression gate --- */
+	if (baseline_path != NULL) {
+		warnConfigMismatch(baseline.config, res.config);
+		std::vector<KernelComparison> cmp = compare_results(baseline, res, threshold_pct, alpha);
+		if (print_comparison(cmp, threshold_pct, alpha) > 0)
+			return EXIT_REGRESSION;
+	}
+
+    return io_errors > 0 ? 1 : 0;
+}
+
+void printStatistics(const RunResult &res) {
+	size_t j;
+
+    printf(HLINE);
+    printf("Function    Best Rate MB/s  Avg time     Min time     Max time\n");
+    for (j=0; j<res.kernels.size(); j++) {
+		const KernelResult &k = res.kernels[j];
+		printf("%s%12.1f  %11.6f  %11.6f  %11.6f\n", label(k).c_str(),
+	       1.0E-06 * k.bytes/k.stats.min,
+	       k.stats.mean,
+	       k.stats.min,
+	       k.stats.max);
+    }
+    printf(HLINE);
+    printf("Function    Median MB/s    Median time   p90 time     p99 time     %2.0f%% CI (median time)      Outliers\n",
+	   100.0 * res.kernels[0].stats.ci_level);
+    for (j=0; j<res.kernels.size(); j++) {
+		const KernelResult &k = res.kernels[j];
+		printf("%s%12.1f  %11.6f  %11.6f  %11.6f  [%11.6f, %11.6f]  %3zu/%zu\n", label(k).c_str(),
+	       1.0E-06 * k.bytes/k.stats.median,
+	       k.stats.median,
+	       k.stats.p90,
+	       k.stats.p99,
+	       k.stats.ci_lo,
+	       k.stats.ci_hi,
+	       k.stats.n_outliers,
+	       k.stats.n);
+    }
+    printf(HLINE);
+    for (j=0; j<res.kernels.size(); j++) {
+		const KernelResult &k = res.kernels[j];
+		if (k.stats.n_outliers == 0)
+			continue;
+		printf("%s outlier iterations (|modified z| > %.1f):", label(k).c_str(), STATS_OUTLIER_Z);
+		for (size_t i = 0; i < k.stats.n; i++)
+			if (k.stats.outlier[i])
+				printf(" %zu (%.6f s)", i + 1, k.times[i + 1]);
+		printf("\n");
+    }
+}
+
+/* Map each per-kernel ROI region (gem5: stats dump, in order) to its kernel */
+void printRoiDumps(const RunResult &res) {
+	printf("Per-kernel ROI regions: %zu\n", res.roi_dumps.size());
+	for (size_t i = 0; i < res.roi_dumps.size(); i++) {
+		const RoiDump &d = res.roi_dumps[i];
+		printf("    dump %3u: %-6s iteration %d\n", d.index, d.kernel.c_str(), d.iteration);
+	}
+	for (size_t j = 0; j < res.kernels.size(); j++) {
+		const KernelResult &k = res.kernels[j];
+		if (k.roi_samples == 0)
+			continue;
+		printf("%s%u regions, %.6f s, %llu instret, %llu cycles, %llu L3 misses\n",
+		       label(k).c_str(), k.roi_samples, k.roi.elapsed_s,
+		       (unsigned long long)k.roi.instret,
+		       (unsigned long long)k.roi.cpu_cycles,
+		       (unsigned long long)k.roi.l3_miss);
+	}
+	printf(HLINE);
+}
+
+/*
+ * One row per distance: median bandwidth of every kernel and the LLC
+ * miss rate of the whole loop (PCM builds only; "n/a" without counters).
+ */
+void printPrefetchSweep(const std::vector<RunResult> &runs) {
+	std::vector<size_t> best(runs[0].kernels.size(), 0);
+
+	printf("Prefetch sweep (%s, locality %d, write prefetch %s), median MB/s\n",
+	       runs[0].config.kernel_variant.c_str(), kernel_params.prefetch_locality,
+	       kernel_params.prefetch_write ? "on" : "off");
+	printf("Lines   Bytes");
+	for (size_t j = 0; j < runs[0].kernels.size(); j++)
+		printf("  %9s", registry_find(runs[0].kernels[j].name.c_str())->label);
+	printf("  LLC miss rate  LLC misses\n");
+	for (size_t r = 0; r < runs.size(); r++) {
+		const RunResult &res = runs[r];
+		printf("%5ld %7ld", res.config.prefetch_lines, res.config.prefetch_lines * CACHE_LINE_BYTES);
+		for (size_t j = 0; j < res.kernels.size(); j++) {
+			const KernelResult &k = res.kernels[j];
+			const KernelResult &b = runs[best[j]].kernels[j];
+			printf("  %9.1f", 1.0E-06 * k.bytes/k.stats.median);
+			if (k.stats.median < b.stats.median)
+				best[j] = r;
 		}
-		printf("     For array b[], %d errors were found.\n",ierr);
-	}
-	if (abs(cAvgErr/cj) > epsilon) {
-		err++;
-		printf ("Failed Validation on array c[], AvgRelAbsErr > epsilon (%e)\n",epsilon);
-		printf ("     Expected Value: %e, AvgAbsErr: %e, AvgRelAbsErr: %e\n",cj,cAvgErr,abs(cAvgErr)/cj);
-		printf ("     AvgRelAbsErr > Epsilon (%e)\n",epsilon);
-		ierr = 0;
-		for (j=0; j<STREAM_ARRAY_SIZE; j++) {
-			if (abs(c[j]/cj-1.0) > epsilon) {
-				ierr++;
-#ifdef VERBOSE
-				if (ierr < 10) {
-					printf("         array c: index: %ld, expected: %e, observed: %e, relative error: %e\n",
-						j,cj,c[j],abs((cj-c[j])/cAvgErr));
-				}
-#endif
-			}
+		uint64_t llc = res.roi.l3_miss + res.roi.l3_hits;
+		if (llc > 0)
+			printf("  %12.2f%%  %10llu", 100.0 * res.roi.l3_miss / llc,
+			       (unsigned long long)res.roi.l3_miss);
+		else
+			printf("  %13s  %10s", "n/a", "n/a");
+		printf("%s\n", res.validation_errors ? "  (failed validation)" : "");
+	}
+	printf("Best distance (lines):");
+	for (size_t j = 0; j < best.size(); j++)
+		printf(" %s %ld%s", runs[0].kernels[j].name.c_str(), runs[best[j]].config.prefetch_lines,
+		       j + 1 < best.size() ? "," : "");
+	printf("\n");
+	printf(HLINE);
+}
+
+/*
+ * One row per stagger: median bandwidth of every kernel, then for each
+ * kernel the stagger it ran slowest at and by how much, against its best.
+ */
+void printOffsetSweep(const std::vector<RunResult> &runs) {
+	std::vector<size_t> best(runs[0].kernels.size(), 0), worst(best);
+
+	printf("Offset sweep (a, b, c at 0, K, 2K past %zu-byte aligned bases), median MB/s\n",
+	       runs[0].config.align);
+	printf("K bytes  K elems");
+	for (size_t j = 0; j < runs[0].kernels.size(); j++)
+		printf("  %9s", registry_find(runs[0].kernels[j].name.c_str())->label);
+	printf("\n");
+	for (size_t r = 0; r < runs.size(); r++) {
+		const RunResult &res = runs[r];
+		printf("%7zu  %7zu", res.config.offsets[1], res.config.offsets[1] / sizeof(STREAM_TYPE));
+		for (size_t j = 0; j < res.kernels.size(); j++) {
+			const KernelResult &k = res.kernels[j];
+			printf("  %9.1f", 1.0E-06 * k.bytes/k.stats.median);
+			if (k.stats.median < runs[best[j]].kernels[j].stats.median)
+				best[j] = r;
+			if (k.stats.median > runs[worst[j]].kernels[j].stats.median)
+				worst[j] = r;
 		}
-		printf("     For array c[], %d errors were found.\n",ierr);
+		printf("%s\n", res.validation_errors ? "  (failed validation)" : "");
 	}
-	if (err == 0) {
-		printf ("Solution Validates: avg error less than %e on all three arrays\n",epsilon);
+	printf("Worst stagger (bytes, vs best):");
+	for (size_t j = 0; j < best.size(); j++)
+		printf(" %s %zu (%+.1f%%)%s", runs[0].kernels[j].name.c_str(), runs[worst[j]].config.offsets[1],
+		       100.0 * (runs[best[j]].kernels[j].stats.median / runs[worst[j]].kernels[j].stats.median - 1.0),
+		       j + 1 < best.size() ? "," : "");
+	printf("\n");
+	printf(HLINE);
+}
+
+/*
+ * RAPL energy of the loop ROI and, with --roi=kernel, of every kernel's
+ * own regions. GB/J counts package plus DRAM energy.
+ */
+void printEnergy(const RunResult &res) {
+	double loop_bytes = 0.0;
+	for (size_t j = 0; j < res.kernels.size(); j++)
+		loop_bytes += res.kernels[j].bytes * res.kernels[j].times.size();
+
+	printf("Function    Package J     DRAM J     Avg W        GB/J\n");
+	for (size_t j = 0; j <= res.kernels.size(); j++) {
+		bool loop = j == res.kernels.size();
+		const RoiMetrics &r = loop ? res.roi : res.kernels[j].roi;
+		if (!loop && res.kernels[j].roi_samples == 0)
+			continue;
+		double bytes = loop ? loop_bytes : res.kernels[j].bytes * res.kernels[j].roi_samples;
+		double joules = r.pkg_energy_j + r.dram_energy_j;
+		printf("%s%10.3f  %9.3f  %8.1f  %10.3f\n", loop ? "Loop:      " : label(res.kernels[j]).c_str(),
+		       r.pkg_energy_j, r.dram_energy_j,
+		       r.elapsed_s > 0.0 ? joules / r.elapsed_s : 0.0,
+		       joules > 0.0 ? 1.0E-09 * bytes / joules : 0.0);
 	}
-#ifdef VERBOSE
-	printf ("Results Validation Verbose Results: \n");
-	printf ("    Expected a(1), b(1), c(1): %f %f %f \n",aj,bj,cj);
-	printf ("    Observed a(1), b(1), c(1): %f %f %f \n",a[1],b[1],c[1]);
-	printf ("    Rel Errors on a, b, c:     %e %e %e \n",abs(aAvgErr/aj),abs(bAvgErr/bj),abs(cAvgErr/cj));
-#endif
-}
\ No newline at end of file
+	if (res.config.roi_mode == "loop")
+		printf("Per-kernel energy needs --roi=kernel.\n");
+	printf(HLINE);
+}
+
+/*
+ * Effective frequency (GHz) of the worker threads over the loop ROI and,
+ * with --roi=kernel, over every kernel's regions.
+ */
+void printFrequency(const RunResult &res) {
+	printf("Function    Mean GHz   Min GHz   Max GHz   per thread\n");
+	for (size_t j = 0; j <= res.kernels.size(); j++) {
+		bool loop = j == res.kernels.size();
+		const RoiMetrics &r = loop ? res.roi : res.kernels[j].roi;
+		if (!loop && res.kernels[j].roi_samples == 0)
+			continue;
+		double mean, min, max;
+		freq_summary(r.freq, &mean, &min, &max);
+		printf("%s%8.3f  %8.3f  %8.3f  ", loop ? "Loop:      " : label(res.kernels[j]).c_str(), mean, min, max);
+		for (int t = 0; t < r.freq.threads && t < 16; t++)
+			printf(" %.2f", freq_ghz(r.freq, t));
+		printf("%s\n", r.freq.threads > 16 ? " ..." : "");
+	}
+	printf(HLINE);
+}
+
+/* What the baseline did not pin down (host, build) or the command line overrode */
+void warnConfigMismatch(const RunConfig &base, const RunConfig &cur) {
+	if (base.num_elements != cur.num_elements)
+		fprintf(stderr, "WARNING: baseline num_elements %llu, current %llu\n",
+			(unsigned long long)base.num_elements, (unsigned long long)cur.num_elements);
+	if (base.bytes_per_word != cur.bytes_per_word)
+		fprintf(stderr, "WARNING: baseline bytes_per_word %d, current %d\n",
+			base.bytes_per_word, cur.bytes_per_word);
+	if (base.threads != cur.threads)
+		fprintf(stderr, "WARNING: baseline threads %d, current %d\n",
+			base.threads, cur.threads);
+	if (base.ntimes != cur.ntimes)
+		fprintf(stderr, "WARNING: baseline ntimes %d, current %d\n",
+			base.ntimes, cur.ntimes);
+	if (base.build_target != cur.build_target || base.kernel_variant != cur.kernel_variant)
+		fprintf(stderr, "WARNING: baseline ran %s/%s, current %s/%s\n",
+			base.build_target.c_str(), base.kernel_variant.c_str(),
+			cur.build_target.c_str(), cur.kernel_variant.c_str());
+	/* Schema /1 baselines read back as align 0, offsets 0 */
+	if (base.align != cur.align || base.offsets[0] != cur.offsets[0] ||
+	    base.offsets[1] != cur.offsets[1] || base.offsets[2] != cur.offsets[2])
+		fprintf(stderr, "WARNING: baseline align %zu offsets %zu,%zu,%zu, current align %zu offsets %zu,%zu,%zu\n",
+			base.align, base.offsets[0], base.offsets[1], base.offsets[2],
+			cur.align, cur.offsets[0], cur.offsets[1], cur.offsets[2]);
+	/* Older baselines do not record it */
+	if (!base.placement.empty() && base.placement != cur.placement)
+		fprintf(stderr, "WARNING: baseline placement %s, current %s\n",
+			base.placement.c_str(), cur.placement.c_str());
+}
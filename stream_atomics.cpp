@@ -0,0 +1,176 @@
+/*-----------------------------------------------------------------------*/
+/* Atomic operation throughput under contention.                         */
+/*-----------------------------------------------------------------------*/
+# include <stdint.h>
+# include <stdlib.h>
+# include <string.h>
+# include "stream_atomics.h"
+# include "stream_kernels.h"
+# include "stream_output.h"
+# include "stream_stats.h"
+# include "stream_timer.h"
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
+# define WORDS_PER_LINE	(CACHE_LINE_BYTES / sizeof(uint64_t))
+
+static const char *op_names[ATOMIC_NOPS] = { "fetch_add", "cas", "exchange" };
+static const char *layout_names[ATOMIC_NLAYOUTS] = { "shared", "padded", "false" };
+
+const char *atomic_op_name(AtomicOp op) {
+	return op_names[op];
+}
+
+const char *atomic_layout_name(AtomicLayout layout) {
+	return layout_names[layout];
+}
+
+/* Returns the number of attempts; only CAS can need more than one per op */
+template<AtomicOp OP>
+static uint64_t atomic_loop(uint64_t *w, long ops) {
+	uint64_t attempts = 0;
+	for (long i = 0; i < ops; i++) {
+		if (OP == ATOMIC_FADD)
+			__atomic_fetch_add(w, 1, __ATOMIC_ACQ_REL);
+		else if (OP == ATOMIC_XCHG)
+			__atomic_exchange_n(w, (uint64_t)i, __ATOMIC_ACQ_REL);
+		else {
+			uint64_t v = __atomic_load_n(w, __ATOMIC_RELAXED);
+			do
+				attempts++;
+			while (!__atomic_compare_exchange_n(w, &v, v + 1, false,
+			                                    __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+			continue;
+		}
+		attempts++;
+	}
+	return attempts;
+}
+
+static uint64_t *target_word(uint64_t *lines, AtomicLayout layout, int t) {
+	switch (layout) {
+	case ATOMIC_SHARED:
+		return lines;
+	case ATOMIC_PADDED:
+		return lines + t * WORDS_PER_LINE;
+	default:
+		return lines + t;	/* consecutive words, WORDS_PER_LINE threads per line */
+	}
+}
+
+void atomic_default_threads(int max_threads, std::vector<long> *threads) {
+	threads->clear();
+	for (long t = 1; t < max_threads; t *= 2)
+		threads->push_back(t);
+	threads->push_back(max_threads);
+}
+
+int atomic_run(const std::vector<long> &threads, int ntimes, std::vector<AtomicResult> *results) {
+	long max_threads = 1;
+	for (size_t i = 0; i < threads.size(); i++)
+		max_threads = threads[i] > max_threads ? threads[i] : max_threads;
+	void *mem;
+	if (posix_memalign(&mem, CACHE_LINE_BYTES, max_threads * CACHE_LINE_BYTES) != 0)
+		return -1;
+	uint64_t *lines = (uint64_t *)mem;
+	std::vector<double> start(max_threads), stop(max_threads), attempts(max_threads);
+	std::vector<double> rate(ntimes), latency(ntimes);
+
+	results->clear();
+	for (int op = 0; op < ATOMIC_NOPS; op++)
+	for (int layout = 0; layout < ATOMIC_NLAYOUTS; layout++)
+	for (size_t ti = 0; ti < threads.size(); ti++) {
+		int nt = threads[ti];
+		double tries = 0.0;
+		memset(lines, 0, max_threads * CACHE_LINE_BYTES);
+		for (int k = 0; k < ntimes; k++) {
+			/* The runtime may grant fewer threads; only the team's slots are set */
+			#pragma omp parallel num_threads(nt)
+			{
+				#ifdef _OPENMP
+				int t = omp_get_thread_num();
+				if (t == 0)
+					nt = omp_get_num_threads();
+				#else
+				int t = 0;
+				nt = 1;
+				#endif
+				uint64_t *w = target_word(lines, (AtomicLayout)layout, t);
+				uint64_t n;
+				#pragma omp barrier
+				start[t] = timer_now();
+				switch (op) {
+				case ATOMIC_FADD: n = atomic_loop<ATOMIC_FADD>(w, ATOMIC_OPS); break;
+				case ATOMIC_CAS:  n = atomic_loop<ATOMIC_CAS>(w, ATOMIC_OPS); break;
+				default:          n = atomic_loop<ATOMIC_XCHG>(w, ATOMIC_OPS); break;
+				}
+				stop[t] = timer_now();
+				attempts[t] = n;
+			}
+			/* Wall time from the first thread in to the last one out */
+			double first = start[0], last = stop[0], busy = 0.0;
+			for (int t = 0; t < nt; t++) {
+				first = start[t] < first ? start[t] : first;
+				last = stop[t] > last ? stop[t] : last;
+				busy += stop[t] - start[t];
+				if (k > 0)
+					tries += attempts[t];
+			}
+			rate[k] = (double)nt * ATOMIC_OPS / (last - first);
+			latency[k] = 1.0E+09 * busy / nt / ATOMIC_OPS;
+		}
+		AtomicResult r;
+		r.op = (AtomicOp)op;
+		r.layout = (AtomicLayout)layout;
+		r.threads = nt;
+		r.ops_per_s = stats_median(&rate[1], ntimes - 1);
+		r.ns_per_op = stats_median(&latency[1], ntimes - 1);
+		r.attempts_per_op = tries / ((double)nt * ATOMIC_OPS * (ntimes - 1));
+		results->push_back(r);
+	}
+	free(lines);
+	return 0;
+}
+
+void atomic_print(FILE *fp, const std::vector<AtomicResult> &results) {
+	fprintf(fp, "Atomics: %d operations per thread, median over repetitions\n", ATOMIC_OPS);
+	fprintf(fp, "Op         Layout  Threads      Mops/s   ns/op  Attempts/op\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		const AtomicResult &r = results[i];
+		fprintf(fp, "%-10s %-7s %7d %11.2f %7.1f %12.2f\n",
+			atomic_op_name(r.op), atomic_layout_name(r.layout), r.threads,
+			1.0E-06 * r.ops_per_s, r.ns_per_op, r.attempts_per_op);
+	}
+}
+
+int atomic_write_json(const char *path, const std::vector<AtomicResult> &results) {
+	FILE *fp = result_open(path);
+	if (fp == NULL)
+		return -1;
+	fprintf(fp, "{\n  \"ops_per_thread\": %d,\n  \"results\": [\n", ATOMIC_OPS);
+	for (size_t i = 0; i < results.size(); i++) {
+		const AtomicResult &r = results[i];
+		fprintf(fp, "    {\"op\": \"%s\", \"layout\": \"%s\", \"threads\": %d,"
+			" \"ops_per_s\": %.1f, \"ns_per_op\": %.3f, \"attempts_per_op\": %.4f}%s\n",
+			atomic_op_name(r.op), atomic_layout_name(r.layout), r.threads,
+			r.ops_per_s, r.ns_per_op, r.attempts_per_op,
+			i + 1 < results.size() ? "," : "");
+	}
+	fprintf(fp, "  ]\n}\n");
+	return result_close(fp);
+}
+
+int atomic_write_csv(const char *path, const std::vector<AtomicResult> &results) {
+	FILE *fp = result_open(path);
+	if (fp == NULL)
+		return -1;
+	fprintf(fp, "op,layout,threads,ops_per_s,ns_per_op,attempts_per_op\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		const AtomicResult &r = results[i];
+		fprintf(fp, "%s,%s,%d,%.1f,%.3f,%.4f\n",
+			atomic_op_name(r.op), atomic_layout_name(r.layout), r.threads,
+			r.ops_per_s, r.ns_per_op, r.attempts_per_op);
+	}
+	return result_close(fp);
+}
@@ -0,0 +1,66 @@
+/*-----------------------------------------------------------------------*/
+/* Atomic operation throughput under contention.                         */
+/*                                                                       */
+/* Every thread of the OpenMP team runs ATOMIC_OPS atomic operations on  */
+/* its own target word. Where the words live decides how much coherence */
+/* traffic the operations cause:                                         */
+/*   shared   all threads hit the same word of one cache line            */
+/*   padded   every thread has a cache line of its own (no sharing)      */
+/*   false    every thread has its own word, but up to a line's worth of */
+/*            threads share each cache line (false sharing)              */
+/* Operations are fetch-add, a load + compare-and-swap retry loop, and   */
+/* exchange, each timed at every thread count of the sweep.              */
+/*-----------------------------------------------------------------------*/
+#ifndef STREAM_ATOMICS_H
+#define STREAM_ATOMICS_H
+
+# include <stdio.h>
+# include <vector>
+
+/* Operations per thread and per timed repetition */
+#ifndef ATOMIC_OPS
+#   define ATOMIC_OPS	(1 << 18)
+#endif
+
+enum AtomicOp {
+	ATOMIC_FADD = 0,
+	ATOMIC_CAS,
+	ATOMIC_XCHG,
+	ATOMIC_NOPS
+};
+
+enum AtomicLayout {
+	ATOMIC_SHARED = 0,
+	ATOMIC_PADDED,
+	ATOMIC_FALSE,
+	ATOMIC_NLAYOUTS
+};
+
+struct AtomicResult {
+	AtomicOp	op;
+	AtomicLayout	layout;
+	int		threads;
+	double		ops_per_s;		/* all threads, median over repetitions */
+	double		ns_per_op;		/* per thread, median over repetitions */
+	double		attempts_per_op;	/* CAS attempts per success; 1 otherwise */
+};
+
+const char *atomic_op_name(AtomicOp op);
+const char *atomic_layout_name(AtomicLayout layout);
+
+/* 1, 2, 4, ... up to and including max_threads */
+void atomic_default_threads(int max_threads, std::vector<long> *threads);
+
+/*
+ * Every op and layout at every thread count; ntimes repetitions each, the
+ * first one untimed. Returns 0 on success.
+ */
+int atomic_run(const std::vector<long> &threads, int ntimes, std::vector<AtomicResult> *results);
+
+void atomic_print(FILE *fp, const std::vector<AtomicResult> &results);
+
+/* Write to 'path' ("-" for stdout); 0 on success */
+int atomic_write_json(const char *path, const std::vector<AtomicResult> &results);
+int atomic_write_csv(const char *path, const std::vector<AtomicResult> &results);
+
+#endif /* STREAM_ATOMICS_H */
@@ -0,0 +1,332 @@
+/*-----------------------------------------------------------------------*/
+/* Baseline comparison and regression gating for STREAM.                 */
+/*-----------------------------------------------------------------------*/
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <math.h>
+# include "stream_baseline.h"
+
+# define HLINE "-------------------------------------------------------------\n"
+
+/* --- Minimal JSON reader, sufficient for our own result files --- */
+
+struct JsonValue {
+	enum Type { NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT } type;
+	double		number;
+	bool		boolean;
+	std::string	str;
+	std::vector<JsonValue> items;
+	std::vector<std::pair<std::string, JsonValue> > members;
+
+	JsonValue() : type(NUL), number(0.0), boolean(false) {}
+
+	const JsonValue *get(const char *key) const {
+		for (size_t i = 0; i < members.size(); i++)
+			if (members[i].first == key)
+				return &members[i].second;
+		return NULL;
+	}
+};
+
+struct JsonParser {
+	const char	*p;
+	const char	*end;
+	std::string	error;
+
+	void skip_ws() {
+		while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+			p++;
+	}
+	bool fail(const char *what) {
+		if (error.empty())
+			error = what;
+		return false;
+	}
+	bool expect(char ch) {
+		skip_ws();
+		if (p >= end || *p != ch)
+			return fail("unexpected character");
+		p++;
+		return true;
+	}
+	bool parse_string(std::string *out) {
+		if (!expect('"'))
+			return false;
+		out->clear();
+		while (p < end && *p != '"') {
+			if (*p == '\\') {
+				if (++p >= end)
+					break;
+				switch (*p) {
+				case 'n': out->push_back('\n'); break;
+				case 't': out->push_back('\t'); break;
+				case 'r': out->push_back('\r'); break;
+				case 'b': out->push_back('\b'); break;
+				case 'f': out->push_back('\f'); break;
+				case 'u':
+					/* Only ASCII escapes are produced by our writer */
+					if (end - p < 5)
+						return fail("truncated \\u escape");
+					out->push_back((char)strtol(std::string(p + 1, 4).c_str(), NULL, 16));
+					p += 4;
+					break;
+				default:  out->push_back(*p); break;
+				}
+				p++;
+			} else {
+				out->push_back(*p++);
+			}
+		}
+		if (p >= end)
+			return fail("unterminated string");
+		p++;
+		return true;
+	}
+	bool parse_value(JsonValue *v) {
+		skip_ws();
+		if (p >= end)
+			return fail("unexpected end of input");
+		if (*p == '{') {
+			v->type = JsonValue::OBJECT;
+			p++;
+			skip_ws();
+			if (p < end && *p == '}') {
+				p++;
+				return true;
+			}
+			for (;;) {
+				std::pair<std::string, JsonValue> m;
+				if (!parse_string(&m.first) || !expect(':') || !parse_value(&m.second))
+					return false;
+				v->members.push_back(m);
+				skip_ws();
+				if (p < end && *p == ',') {
+					p++;
+					continue;
+				}
+				return expect('}');
+			}
+		}
+		if (*p == '[') {
+			v->type = JsonValue::ARRAY;
+			p++;
+			skip_ws();
+			if (p < end && *p == ']') {
+				p++;
+				return true;
+			}
+			for (;;) {
+				JsonValue item;
+				if (!parse_value(&item))
+					return false;
+				v->items.push_back(item);
+				skip_ws();
+				if (p < end && *p == ',') {
+					p++;
+					continue;
+				}
+				return expect(']');
+			}
+		}
+		if (*p == '"') {
+			v->type = JsonValue::STRING;
+			return parse_string(&v->str);
+		}
+		if (end - p >= 4 && strncmp(p, "true", 4) == 0) {
+			v->type = JsonValue::BOOL;
+			v->boolean = true;
+			p += 4;
+			return true;
+		}
+		if (end - p >= 5 && strncmp(p, "false", 5) == 0) {
+			v->type = JsonValue::BOOL;
+			p += 5;
+			return true;
+		}
+		if (end - p >= 4 && strncmp(p, "null", 4) == 0) {
+			v->type = JsonValue::NUL;
+			v->number = NAN;
+			p += 4;
+			return true;
+		}
+		char *stop;
+		v->number = strtod(p, &stop);
+		if (stop == p)
+			return fail("invalid value");
+		v->type = JsonValue::NUMBER;
+		p = stop;
+		return true;
+	}
+};
+
+static double json_num(const JsonValue *v, double dflt) {
+	return (v != NULL && v->type == JsonValue::NUMBER) ? v->number : dflt;
+}
+
+static std::string json_str(const JsonValue *v) {
+	return (v != NULL && v->type == JsonValue::STRING) ? v->str : std::string();
+}
+
+int load_result_json(const char *path, RunResult *out, std::string *err) {
+	FILE *fp = fopen(path, "r");
+	if (fp == NULL) {
+		*err = std::string("cannot open ") + path;
+		return -1;
+	}
+	std::string text;
+	char buf[65536];
+	size_t got;
+	while ((got = fread(buf, 1, sizeof(buf), fp)) > 0)
+		text.append(buf, got);
+	fclose(fp);
+
+	JsonParser jp;
+	jp.p = text.data();
+	jp.end = text.data() + text.size();
+	JsonValue root;
+	if (!jp.parse_value(&root) || root.type != JsonValue::OBJECT) {
+		*err = "malformed JSON: " + (jp.error.empty() ? std::string("not an object") : jp.error);
+		return -1;
+	}
+	std::string schema = json_str(root.get("schema"));
+	/* /1 differs only by the OFFSET macro in place of align and offsets */
+	if (schema != RESULT_SCHEMA && schema != "band_stream/1") {
+		*err = "unsupported schema '" + schema + "', expected " RESULT_SCHEMA;
+		return -1;
+	}
+
+	const JsonValue *cfg = root.get("config");
+	const JsonValue *kernels = root.get("kernels");
+	if (cfg == NULL || cfg->type != JsonValue::OBJECT ||
+	    kernels == NULL || kernels->type != JsonValue::ARRAY) {
+		*err = "missing config or kernels";
+		return -1;
+	}
+	RunConfig &c = out->config;
+	c.hostname       = json_str(cfg->get("hostname"));
+	c.timestamp      = json_str(cfg->get("timestamp"));
+	c.build_target   = json_str(cfg->get("build_target"));
+	c.kernel_variant = json_str(cfg->get("kernel_variant"));
+	const JsonValue *extra = cfg->get("extra_kernels");
+	if (extra != NULL && extra->type == JsonValue::ARRAY)
+		for (size_t i = 0; i < extra->items.size(); i++)
+			c.extra_kernels.push_back(json_str(&extra->items[i]));
+	c.stride         = (long)json_num(cfg->get("stride"), 0);
+	c.prefetch_lines = (long)json_num(cfg->get("prefetch_lines"), 0);
+	c.placement      = json_str(cfg->get("placement"));
+	c.setup_s        = json_num(cfg->get("setup_s"), NAN);
+	c.setup_faults   = (uint64_t)json_num(cfg->get("setup_faults"), 0);
+	c.num_elements   = (uint64_t)json_num(cfg->get("num_elements"), 0);
+	c.bytes_per_word = (int)json_num(cfg->get("bytes_per_word"), 0);
+	c.ntimes         = (int)json_num(cfg->get("ntimes"), 0);
+	c.threads        = (int)json_num(cfg->get("threads"), 0);
+	c.lproc_id       = (int32_t)json_num(cfg->get("lproc_id"), -1);
+	c.page_size      = (long)json_num(cfg->get("page_size"), 0);
+	c.align          = (size_t)json_num(cfg->get("align"), 0);
+	const JsonValue *offsets = cfg->get("offsets");
+	if (offsets != NULL && offsets->type == JsonValue::ARRAY)
+		for (size_t i = 0; i < 3 && i < offsets->items.size(); i++)
+			c.offsets[i] = (size_t)json_num(&offsets->items[i], 0);
+	c.timer          = json_str(cfg->get("timer"));
+	c.timer_hz       = json_num(cfg->get("timer_hz"), NAN);
+	c.timer_resolution_s = json_num(cfg->get("timer_resolution_s"), NAN);
+	c.timer_overhead_s   = json_num(cfg->get("timer_overhead_s"), NAN);
+	c.roi_mode       = json_str(cfg->get("roi_mode"));
+	c.roi_iteration  = (int)json_num(cfg->get("roi_iteration"), -1);
+	if (c.num_elements == 0) {
+		*err = "config.num_elements missing";
+		return -1;
+	}
+
+	out->kernels.clear();
+	for (size_t i = 0; i < kernels->items.size(); i++) {
+		const JsonValue &kv = kernels->items[i];
+		const JsonValue *times = kv.get("times_s");
+		if (kv.type != JsonValue::OBJECT || times == NULL || times->type != JsonValue::ARRAY) {
+			*err = "kernel entry without times_s";
+			return -1;
+		}
+		KernelResult k;
+		k.name  = json_str(kv.get("name"));
+		k.bytes = json_num(kv.get("bytes"), NAN);
+		for (size_t t = 0; t < times->items.size(); t++)
+			k.times.push_back(json_num(&times->items[t], NAN));
+		out->kernels.push_back(k);
+	}
+	const JsonValue *val = root.get("validation");
+	out->validation_errors = (int)json_num(val ? val->get("errors") : NULL, 0);
+	roi_metrics_zero(&out->roi);
+	result_summarize(out);
+	return 0;
+}
+
+/* Per-iteration bandwidths, warm-up excluded */
+static std::vector<double> timed_bandwidths(const KernelResult &k) {
+	std::vector<double> bw;
+	for (size_t t = 1; t < k.times.size(); t++)
+		if (k.times[t] > 0.0)
+			bw.push_back(1.0E-06 * k.bytes / k.times[t]);
+	return bw;
+}
+
+std::vector<KernelComparison> compare_results(const RunResult &baseline,
+                                              const RunResult &current,
+                                              double threshold_pct,
+                                              double alpha) {
+	std::vector<KernelComparison> out;
+	for (size_t i = 0; i < current.kernels.size(); i++) {
+		const KernelResult &cur = current.kernels[i];
+		const KernelResult *base = NULL;
+		for (size_t b = 0; b < baseline.kernels.size(); b++)
+			if (baseline.kernels[b].name == cur.name)
+				base = &baseline.kernels[b];
+		if (base == NULL) {
+			fprintf(stderr, "WARNING: kernel %s is not in the baseline; not compared\n", cur.name.c_str());
+			continue;
+		}
+
+		std::vector<double> bw_cur  = timed_bandwidths(cur);
+		std::vector<double> bw_base = timed_bandwidths(*base);
+		if (bw_cur.empty() || bw_base.empty())
+			continue;
+
+		KernelComparison kc;
+		kc.name          = cur.name;
+		kc.baseline_MBps = stats_median(bw_base.data(), bw_base.size());
+		kc.current_MBps  = stats_median(bw_cur.data(), bw_cur.size());
+		kc.change_pct    = 100.0 * (kc.current_MBps - kc.baseline_MBps) / kc.baseline_MBps;
+		kc.p_value       = stats_mann_whitney_less(bw_cur.data(), bw_cur.size(),
+		                                           bw_base.data(), bw_base.size());
+		kc.regressed     = kc.change_pct < -threshold_pct && kc.p_value < alpha;
+		out.push_back(kc);
+	}
+	for (size_t b = 0; b < baseline.kernels.size(); b++) {
+		bool found = false;
+		for (size_t i = 0; i < current.kernels.size(); i++)
+			found = found || current.kernels[i].name == baseline.kernels[b].name;
+		if (!found)
+			fprintf(stderr, "WARNING: baseline kernel %s did not run; not compared\n",
+				baseline.kernels[b].name.c_str());
+	}
+	return out;
+}
+
+int print_comparison(const std::vector<KernelComparison> &cmp,
+                     double threshold_pct, double alpha) {
+	int regressions = 0;
+	printf(HLINE);
+	printf("Baseline comparison (median MB/s, regression: drop > %.1f%% with p < %.3g)\n",
+	       threshold_pct, alpha);
+	printf("Function    Baseline MB/s  Current MB/s   Change     p-value   Verdict\n");
+	for (size_t i = 0; i < cmp.size(); i++) {
+		const KernelComparison &kc = cmp[i];
+		printf("%-11s %13.1f  %12.1f  %+7.2f%%  %9.4f   %s\n",
+		       kc.name.c_str(), kc.baseline_MBps, kc.current_MBps,
+		       kc.change_pct, kc.p_value, kc.regressed ? "REGRESSION" : "ok");
+		if (kc.regressed)
+			regressions++;
+	}
+	printf(HLINE);
+	return regressions;
+}
@@ -0,0 +1,54 @@
+/*-----------------------------------------------------------------------*/
+/* Baseline comparison and regression gating for STREAM.                 */
+/*                                                                       */
+/* A previous --json result is loaded as the baseline. For every kernel  */
+/* present in both runs the per-iteration bandwidths (warm-up excluded)  */
+/* are compared with a one-sided Mann-Whitney U test; a kernel regresses */
+/* when its median bandwidth drops by more than the threshold *and* the  */
+/* drop is statistically significant.                                    */
+/*-----------------------------------------------------------------------*/
+#ifndef STREAM_BASELINE_H
+#define STREAM_BASELINE_H
+
+# include <string>
+# include <vector>
+# include "stream_output.h"
+
+/* Process exit status when at least one kernel regressed */
+# define EXIT_REGRESSION	2
+
+/* Defaults for --threshold (percent) and --alpha */
+#ifndef BASELINE_THRESHOLD_PCT
+#   define BASELINE_THRESHOLD_PCT	5.0
+#endif
+#ifndef BASELINE_ALPHA
+#   define BASELINE_ALPHA	0.05
+#endif
+
+struct KernelComparison {
+	std::string	name;
+	double		baseline_MBps;	/* median over timed iterations */
+	double		current_MBps;
+	double		change_pct;	/* negative is slower */
+	double		p_value;	/* H1: current bandwidth < baseline */
+	bool		regressed;
+};
+
+/*
+ * Read a result written by write_result_json(). Only the fields needed
+ * to re-run and compare are required; returns 0 on success, otherwise
+ * -1 with a description in *err.
+ */
+int load_result_json(const char *path, RunResult *out, std::string *err);
+
+/* Compare kernels by name; a kernel missing from either side is skipped with a WARNING */
+std::vector<KernelComparison> compare_results(const RunResult &baseline,
+                                              const RunResult &current,
+                                              double threshold_pct,
+                                              double alpha);
+
+/* Print the comparison table; returns the number of regressed kernels */
+int print_comparison(const std::vector<KernelComparison> &cmp,
+                     double threshold_pct, double alpha);
+
+#endif /* STREAM_BASELINE_H */
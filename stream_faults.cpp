@@ -0,0 +1,207 @@
+/*-----------------------------------------------------------------------*/
+/* First-touch (page fault) cost.                                        */
+/*-----------------------------------------------------------------------*/
+# include <stdint.h>
+# include <stdlib.h>
+# include <string.h>
+# include <errno.h>
+# include <unistd.h>
+# include <sys/mman.h>
+# include <sys/resource.h>
+# include "stream_faults.h"
+# include "stream_output.h"
+# include "stream_stats.h"
+# include "stream_timer.h"
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
+/* Older headers; the kernel answers EINVAL if it does not know them */
+#ifndef MADV_POPULATE_WRITE
+#   define MADV_POPULATE_WRITE	23
+#endif
+
+# define HUGE_BYTES	(2UL << 20)
+
+static const char *method_names[FAULT_NMETHODS] = { "4k", "thp", "map-populate", "madv-populate" };
+
+const char *fault_method_name(FaultMethod m) {
+	return method_names[m];
+}
+
+const char *fault_thp_mode() {
+	static char mode[16];
+	char line[128];
+	FILE *fp = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+	if (fp == NULL)
+		return "unknown";
+	if (fgets(line, sizeof(line), fp) == NULL || sscanf(line, "%*[^[][%15[^]]", mode) != 1)
+		strcpy(mode, "unknown");
+	fclose(fp);
+	return mode;
+}
+
+static uint64_t page_faults() {
+	struct rusage ru;
+	getrusage(RUSAGE_SELF, &ru);
+	return ru.ru_minflt + ru.ru_majflt;
+}
+
+/* A mapping of 'bytes' at the alignment the method wants */
+struct Mapping {
+	char	*base;		/* as returned by mmap */
+	size_t	len;
+	char	*p;		/* aligned start of 'bytes' */
+};
+
+static int map_buffer(FaultMethod m, size_t bytes, Mapping *map) {
+	int flags = MAP_PRIVATE | MAP_ANONYMOUS | (m == FAULT_MAP_POPULATE ? MAP_POPULATE : 0);
+	map->len = bytes + (m == FAULT_THP ? HUGE_BYTES : 0);
+	map->base = (char *)mmap(NULL, map->len, PROT_READ | PROT_WRITE, flags, -1, 0);
+	if (map->base == MAP_FAILED)
+		return -1;
+	map->p = map->base;
+	if (m == FAULT_THP) {
+		map->p = (char *)(((uintptr_t)map->base + HUGE_BYTES - 1) & ~(HUGE_BYTES - 1));
+		madvise(map->p, bytes, MADV_HUGEPAGE);
+	} else if (m == FAULT_4K) {
+		madvise(map->p, bytes, MADV_NOHUGEPAGE);
+	}
+	return 0;
+}
+
+/* This thread's whole pages of [0, bytes) */
+static void page_range(size_t bytes, size_t page, int t, int nt, size_t *lo, size_t *hi) {
+	size_t pages = (bytes + page - 1) / page;
+	*lo = pages * t / nt * page;
+	*hi = pages * (t + 1) / nt * page;
+	if (*hi > bytes)
+		*hi = bytes;
+}
+
+/* Fault in [lo, hi) of the mapping; 0 on success, else errno */
+static int populate(FaultMethod m, char *p, size_t lo, size_t hi, size_t page) {
+	if (m == FAULT_MAP_POPULATE)
+		return 0;
+	if (m == FAULT_MADV_POPULATE)
+		return hi > lo && madvise(p + lo, hi - lo, MADV_POPULATE_WRITE) != 0 ? errno : 0;
+	for (size_t off = lo; off < hi; off += page)
+		((volatile char *)p)[off] = 0;
+	return 0;
+}
+
+int fault_run(size_t bytes, int max_threads, int ntimes, std::vector<FaultResult> *results) {
+	const size_t page = sysconf(_SC_PAGESIZE);
+	std::vector<double> times(ntimes);
+	std::vector<double> faults(ntimes);
+	int threads[2] = { 1, max_threads };
+
+	results->clear();
+	for (int m = 0; m < FAULT_NMETHODS; m++)
+	for (int ti = 0; ti < (max_threads > 1 ? 2 : 1); ti++) {
+		int nt = threads[ti];
+		FaultResult r;
+		r.method = (FaultMethod)m;
+		r.threads = nt;
+		r.supported = true;
+		r.bytes = bytes;
+		/* One mmap() call does all the work */
+		if (m == FAULT_MAP_POPULATE && nt > 1)
+			continue;
+		for (int k = 0; k < ntimes && r.supported; k++) {
+			Mapping map;
+			int failed = 0;
+			uint64_t f0 = page_faults();
+			double t0 = timer_now();
+			if (map_buffer((FaultMethod)m, bytes, &map) != 0)
+				return -1;
+			#pragma omp parallel num_threads(nt) reduction(max:failed)
+			{
+				/* Split by the team actually granted so every page is touched */
+				#ifdef _OPENMP
+				int t = omp_get_thread_num(), team = omp_get_num_threads();
+				#else
+				int t = 0, team = 1;
+				#endif
+				size_t lo, hi;
+				if (t == 0)
+					r.threads = team;
+				page_range(bytes, page, t, team, &lo, &hi);
+				failed = populate((FaultMethod)m, map.p, lo, hi, page);
+			}
+			times[k] = timer_now() - t0;
+			faults[k] = page_faults() - f0;
+			munmap(map.base, map.len);
+			if (failed == EINVAL)
+				r.supported = false;
+			else if (failed != 0)
+				return -1;
+		}
+		if (r.supported) {
+			r.median_s = stats_median(&times[1], ntimes - 1);
+			r.min_s = times[1];
+			for (int k = 2; k < ntimes; k++)
+				r.min_s = times[k] < r.min_s ? times[k] : r.min_s;
+			r.faults = (uint64_t)stats_median(&faults[1], ntimes - 1);
+			r.us_per_fault = r.faults > 0 ? 1.0E+06 * r.median_s * r.threads / r.faults : 0.0;
+		} else {
+			r.median_s = r.min_s = r.us_per_fault = 0.0;
+			r.faults = 0;
+		}
+		results->push_back(r);
+	}
+	return 0;
+}
+
+void fault_print(FILE *fp, const std::vector<FaultResult> &results) {
+	fprintf(fp, "First touch: %.1f MiB per mapping, THP %s, median over repetitions\n",
+		results.empty() ? 0.0 : results[0].bytes / 1048576.0, fault_thp_mode());
+	fprintf(fp, "Method          Threads   Median ms    Min ms      GB/s     Faults  us/fault\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		const FaultResult &r = results[i];
+		if (!r.supported) {
+			fprintf(fp, "%-15s %7d   not supported by this kernel\n",
+				fault_method_name(r.method), r.threads);
+			continue;
+		}
+		fprintf(fp, "%-15s %7d %11.3f %9.3f %9.2f %10llu %9.3f\n",
+			fault_method_name(r.method), r.threads,
+			1.0E+03 * r.median_s, 1.0E+03 * r.min_s, 1.0E-09 * r.bytes / r.median_s,
+			(unsigned long long)r.faults, r.us_per_fault);
+	}
+}
+
+int fault_write_json(const char *path, const std::vector<FaultResult> &results) {
+	FILE *fp = result_open(path);
+	if (fp == NULL)
+		return -1;
+	fprintf(fp, "{\n  \"thp\": \"%s\",\n  \"page_size\": %ld,\n  \"results\": [\n",
+		fault_thp_mode(), sysconf(_SC_PAGESIZE));
+	for (size_t i = 0; i < results.size(); i++) {
+		const FaultResult &r = results[i];
+		fprintf(fp, "    {\"method\": \"%s\", \"threads\": %d, \"supported\": %s, \"bytes\": %zu,"
+			" \"median_s\": %.9g, \"min_s\": %.9g, \"GBps\": %.4f, \"faults\": %llu,"
+			" \"us_per_fault\": %.4f}%s\n",
+			fault_method_name(r.method), r.threads, r.supported ? "true" : "false", r.bytes,
+			r.median_s, r.min_s, r.supported ? 1.0E-09 * r.bytes / r.median_s : 0.0,
+			(unsigned long long)r.faults, r.us_per_fault,
+			i + 1 < results.size() ? "," : "");
+	}
+	fprintf(fp, "  ]\n}\n");
+	return result_close(fp);
+}
+
+int fault_write_csv(const char *path, const std::vector<FaultResult> &results) {
+	FILE *fp = result_open(path);
+	if (fp == NULL)
+		return -1;
+	fprintf(fp, "method,threads,supported,bytes,median_s,min_s,GBps,faults,us_per_fault\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		const FaultResult &r = results[i];
+		fprintf(fp, "%s,%d,%d,%zu,%.9g,%.9g,%.4f,%llu,%.4f\n",
+			fault_method_name(r.method), r.threads, r.supported ? 1 : 0, r.bytes,
+			r.median_s, r.min_s, r.supported ? 1.0E-09 * r.bytes / r.median_s : 0.0,
+			(unsigned long long)r.faults, r.us_per_fault);
+	}
+	return result_close(fp);
+}
@@ -0,0 +1,63 @@
+/*-----------------------------------------------------------------------*/
+/* First-touch (page fault) cost.                                        */
+/*                                                                       */
+/* Maps a fresh anonymous buffer and makes every page of it writable,    */
+/* timed from mmap() until the last page is in:                          */
+/*   4k             MADV_NOHUGEPAGE, one store per page                  */
+/*   thp            2 MiB aligned, MADV_HUGEPAGE, one store per page     */
+/*   map-populate   MAP_POPULATE, the kernel faults it all in mmap()     */
+/*   madv-populate  madvise(MADV_POPULATE_WRITE) (Linux 5.14+)           */
+/* Each at one thread and at the OpenMP team size, the threads taking    */
+/* contiguous page ranges (map-populate is a single call: one thread).   */
+/* Faults come from getrusage(), so they count what the kernel actually  */
+/* took: about one per 2 MiB when THP is effective.                      */
+/*-----------------------------------------------------------------------*/
+#ifndef STREAM_FAULTS_H
+#define STREAM_FAULTS_H
+
+# include <stdio.h>
+# include <stdint.h>
+# include <vector>
+
+/* Default buffer per repetition, in MiB */
+#ifndef FAULT_MIB
+#   define FAULT_MIB	1024
+#endif
+
+enum FaultMethod {
+	FAULT_4K = 0,
+	FAULT_THP,
+	FAULT_MAP_POPULATE,
+	FAULT_MADV_POPULATE,
+	FAULT_NMETHODS
+};
+
+struct FaultResult {
+	FaultMethod	method;
+	int		threads;
+	bool		supported;	/* false: the kernel refused, no numbers */
+	size_t		bytes;
+	double		median_s;	/* over repetitions */
+	double		min_s;
+	uint64_t	faults;		/* per repetition, median */
+	double		us_per_fault;	/* thread time: median_s * threads / faults */
+};
+
+const char *fault_method_name(FaultMethod m);
+
+/* THP mode of the host ("always", "madvise", "never"), or "unknown" */
+const char *fault_thp_mode();
+
+/*
+ * Every method at 1 and at max_threads threads; ntimes repetitions over
+ * fresh mappings of 'bytes' each, the first one untimed. 0 on success.
+ */
+int fault_run(size_t bytes, int max_threads, int ntimes, std::vector<FaultResult> *results);
+
+void fault_print(FILE *fp, const std::vector<FaultResult> &results);
+
+/* Write to 'path' ("-" for stdout); 0 on success */
+int fault_write_json(const char *path, const std::vector<FaultResult> &results);
+int fault_write_csv(const char *path, const std::vector<FaultResult> &results);
+
+#endif /* STREAM_FAULTS_H */
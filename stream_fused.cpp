@@ -0,0 +1,72 @@
+/*-----------------------------------------------------------------------*/
+/* Fused (tiled) execution of the four STREAM kernels.                   */
+/*-----------------------------------------------------------------------*/
+# include "stream_fused.h"
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
+void fused_run(const KernelSet *ks, STREAM_TYPE *a, STREAM_TYPE *b, STREAM_TYPE *c,
+               ssize_t n, int ntimes, ssize_t block_elements, STREAM_TYPE scalar,
+               int32_t lproc_id, FusedResult *res) {
+	res->block_elements = block_elements;
+	res->bytes = 10 * sizeof(STREAM_TYPE) * (double)n;
+	res->times.resize(ntimes);
+
+	ROICounter start(lproc_id);
+	ROICounter stop(lproc_id);
+	start.start_roi();
+	for (int k = 0; k < ntimes; k++) {
+		res->times[k] = timer_now();
+		#pragma omp parallel
+		{
+			ssize_t lo, hi;
+			kernel_chunk(n, &lo, &hi);
+			for (ssize_t j = lo; j < hi; j += block_elements) {
+				ssize_t m = hi - j < block_elements ? hi - j : block_elements;
+				ks->copy(c+j, a+j, m);
+				ks->scale(b+j, c+j, scalar, m);
+				ks->add(c+j, a+j, b+j, m);
+				ks->triad(a+j, b+j, c+j, scalar, m);
+			}
+		}
+		res->times[k] = timer_now() - res->times[k];
+	}
+	stop.stop_roi();
+	res->roi = (stop - start).metrics();
+	res->stats = stats_summarize(&res->times[1], ntimes - 1);
+}
+
+/*
+ * The unfused time of an iteration is the sum of its four kernel times.
+ * DRAM traffic is estimated from LLC misses of the ROI thread (one line
+ * each), so the reduction is only reported when counters are available.
+ */
+void fused_print(FILE *fp, const FusedResult &fused, const RunResult &unfused) {
+	size_t ntimes = fused.times.size();
+	std::vector<double> total(ntimes > 0 ? ntimes - 1 : 0, 0.0);
+	for (size_t j = 0; j < unfused.kernels.size(); j++)
+		for (size_t k = 1; k < ntimes && k < unfused.kernels[j].times.size(); k++)
+			total[k-1] += unfused.kernels[j].times[k];
+	double unfused_median = stats_median(&total[0], total.size());
+
+	fprintf(fp, "Fused Copy->Scale->Add->Triad, %zd elements (%.1f KiB) per array and block\n",
+		fused.block_elements, fused.block_elements * sizeof(STREAM_TYPE) / 1024.0);
+	fprintf(fp, "Mode        Median time   Effective MB/s   LLC misses   Est. DRAM MiB\n");
+	const RoiMetrics *roi[2] = { &unfused.roi, &fused.roi };
+	const char *mode[2] = { "Unfused:  ", "Fused:    " };
+	double median[2] = { unfused_median, fused.stats.median };
+	for (int i = 0; i < 2; i++) {
+		fprintf(fp, "%s%12.6f  %15.1f", mode[i], median[i], 1.0E-06 * fused.bytes / median[i]);
+		if (roi[i]->l3_miss + roi[i]->l3_hits > 0)
+			fprintf(fp, "  %11llu  %14.1f\n", (unsigned long long)roi[i]->l3_miss,
+				roi[i]->l3_miss * (double)CACHE_LINE_BYTES / (1024.0 * 1024.0));
+		else
+			fprintf(fp, "  %11s  %14s\n", "n/a", "n/a");
+	}
+	fprintf(fp, "Speedup: %.2fx", unfused_median / fused.stats.median);
+	if (unfused.roi.l3_miss > 0 && fused.roi.l3_miss + fused.roi.l3_hits > 0)
+		fprintf(fp, ", DRAM traffic reduction: %.1f%%",
+			100.0 * (1.0 - (double)fused.roi.l3_miss / unfused.roi.l3_miss));
+	fprintf(fp, "%s\n", fused.validation_errors ? " (fused run failed validation)" : "");
+}
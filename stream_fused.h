@@ -0,0 +1,46 @@
+/*-----------------------------------------------------------------------*/
+/* Fused (tiled) execution of the four STREAM kernels.                   */
+/*                                                                       */
+/* Instead of four full passes over the arrays, every thread walks its   */
+/* chunk in cache-sized blocks and runs Copy, Scale, Add and Triad on a  */
+/* block before moving to the next. Per element the operations and their */
+/* order are unchanged, so the arrays end up exactly as after the        */
+/* unfused loop and checkSTREAMresults() applies as is. Only the DRAM    */
+/* traffic changes: the block stays cache-resident between the kernels.  */
+/*-----------------------------------------------------------------------*/
+#ifndef STREAM_FUSED_H
+#define STREAM_FUSED_H
+
+# include <stdio.h>
+# include <sys/types.h>
+# include <vector>
+# include "stream_kernels.h"
+# include "stream_stats.h"
+# include "stream_output.h"
+# include "roi_counter.h"
+
+/* Default block size per array for --fused, in KiB (3 arrays share the cache) */
+#ifndef FUSED_BLOCK_KIB
+#   define FUSED_BLOCK_KIB	64
+#endif
+
+struct FusedResult {
+	ssize_t		block_elements;	/* per array */
+	double		bytes;		/* STREAM bytes of all four kernels, one iteration */
+	std::vector<double> times;	/* every iteration; times[0] is warm-up */
+	SampleStats	stats;		/* over times[1..] */
+	RoiMetrics	roi;		/* whole fused loop */
+	int		validation_errors;
+
+	FusedResult() : block_elements(0), bytes(0.0), validation_errors(0) { roi_metrics_zero(&roi); }
+};
+
+/* ntimes fused iterations of 'ks' over a, b, c in blocks of block_elements */
+void fused_run(const KernelSet *ks, STREAM_TYPE *a, STREAM_TYPE *b, STREAM_TYPE *c,
+               ssize_t n, int ntimes, ssize_t block_elements, STREAM_TYPE scalar,
+               int32_t lproc_id, FusedResult *res);
+
+/* Fused against the unfused run of the same configuration */
+void fused_print(FILE *fp, const FusedResult &fused, const RunResult &unfused);
+
+#endif /* STREAM_FUSED_H */
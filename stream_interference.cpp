@@ -0,0 +1,356 @@
+/*-----------------------------------------------------------------------*/
+/* Noisy-neighbour interference mode.                                    */
+/*-----------------------------------------------------------------------*/
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
+# include <pthread.h>
+# include <sched.h>
+# include <stdint.h>
+# include <stdlib.h>
+# include <string.h>
+# include <time.h>
+# include "stream_interference.h"
+# include "stream_output.h"
+# include "stream_threads.h"
+# include "stream_timer.h"
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
+/* Work between two checks of the stop flag, bytes */
+# define AGGRESSOR_BLOCK	(1 << 20)
+
+/* Aggressors run this long before the victim starts timing */
+# define AGGRESSOR_RAMP_MS	20
+
+static const char *pattern_names[] = { "triad", "random", "thrash" };
+
+struct Aggressor {
+	pthread_t	thread;
+	AggressorPattern pattern;
+	size_t		bytes;
+	char		*buf;		/* triad: three arrays of bytes/3 */
+	uint64_t	done;		/* bytes of traffic so far */
+};
+
+static int aggressors_running;
+
+static void *aggressor_main(void *arg) {
+	Aggressor *ag = (Aggressor *)arg;
+	const size_t lines = ag->bytes / CACHE_LINE_BYTES;
+	const size_t words = CACHE_LINE_BYTES / sizeof(uint64_t);
+	uint64_t *p = (uint64_t *)ag->buf;
+	uint64_t x = 88172645463325252ULL ^ (uintptr_t)ag;
+	size_t pos = 0;
+
+	while (__atomic_load_n(&aggressors_running, __ATOMIC_RELAXED)) {
+		uint64_t moved = 0;
+		switch (ag->pattern) {
+		case AGGRESSOR_TRIAD: {
+			ssize_t n = ag->bytes / 3 / sizeof(STREAM_TYPE);
+			ssize_t blk = AGGRESSOR_BLOCK / sizeof(STREAM_TYPE);
+			STREAM_TYPE *ta = (STREAM_TYPE *)ag->buf;
+			if (pos + blk > (size_t)n)
+				pos = 0;
+			kernel_set_scalar.triad(ta + pos, ta + n + pos, ta + 2*n + pos, 3.0, blk);
+			pos += blk;
+			moved = 3 * AGGRESSOR_BLOCK;
+			break;
+		}
+		case AGGRESSOR_RANDOM:
+			for (size_t i = 0; i < AGGRESSOR_BLOCK / CACHE_LINE_BYTES; i++) {
+				x ^= x << 13; x ^= x >> 7; x ^= x << 17;	/* xorshift64 */
+				p[(x % lines) * words]++;
+			}
+			moved = AGGRESSOR_BLOCK;
+			break;
+		case AGGRESSOR_THRASH:
+			for (size_t i = 0; i < AGGRESSOR_BLOCK / CACHE_LINE_BYTES; i++) {
+				p[pos * words] = pos;
+				if (++pos == lines)
+					pos = 0;
+			}
+			moved = AGGRESSOR_BLOCK;
+			break;
+		}
+		__atomic_store_n(&ag->done, ag->done + moved, __ATOMIC_RELAXED);
+	}
+	return NULL;
+}
+
+static int aggressors_start(std::vector<Aggressor> &ags, const std::vector<long> &cpus, int count) {
+	__atomic_store_n(&aggressors_running, 1, __ATOMIC_RELAXED);
+	for (int i = 0; i < count; i++) {
+		ags[i].done = 0;
+		if (thread_start_pinned(&ags[i].thread, cpus[i], aggressor_main, &ags[i]) != 0) {
+			fprintf(stderr, "Cannot start aggressor on CPU %ld\n", cpus[i]);
+			__atomic_store_n(&aggressors_running, 0, __ATOMIC_RELAXED);
+			for (int j = 0; j < i; j++)
+				pthread_join(ags[j].thread, NULL);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static uint64_t aggressors_stop(std::vector<Aggressor> &ags, int count) {
+	uint64_t bytes = 0;
+	__atomic_store_n(&aggressors_running, 0, __ATOMIC_RELAXED);
+	for (int i = 0; i < count; i++) {
+		pthread_join(ags[i].thread, NULL);
+		bytes += ags[i].done;
+	}
+	return bytes;
+}
+
+/* A random cyclic permutation of the lines (Sattolo), one hop per line */
+static size_t *latency_buffer(size_t bytes) {
+	const size_t stride = CACHE_LINE_BYTES / sizeof(size_t);
+	size_t lines = bytes / CACHE_LINE_BYTES;
+	size_t *buf = (size_t *)malloc(lines * CACHE_LINE_BYTES);
+	std::vector<size_t> perm(lines);
+	uint64_t x = 0x9e3779b97f4a7c15ULL;
+	if (buf == NULL)
+		return NULL;
+	for (size_t i = 0; i < lines; i++)
+		perm[i] = i;
+	for (size_t i = lines - 1; i > 0; i--) {
+		x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+		size_t j = x % i;
+		size_t t = perm[i]; perm[i] = perm[j]; perm[j] = t;
+	}
+	for (size_t i = 0; i < lines; i++)
+		buf[perm[i] * stride] = perm[(i + 1) % lines] * stride;
+	return buf;
+}
+
+static double latency_probe(const size_t *buf) {
+	size_t p = 0;
+	double t = timer_now();
+	for (long i = 0; i < INTERFERENCE_LATENCY_LOADS; i++)
+		p = buf[p];
+	t = timer_now() - t;
+	/* Keep the chase alive */
+	if (p == (size_t)-1)
+		fprintf(stderr, "%zu\n", p);
+	return 1.0E+09 * t / INTERFERENCE_LATENCY_LOADS;
+}
+
+/*
+ * Pin the victim team to the CPUs of our mask that no aggressor uses, one
+ * thread per CPU, and return its size (0: the aggressors take every CPU).
+ * Every thread's original mask is saved for victim_unpin().
+ */
+static int victim_pin(const std::vector<long> &aggressors, std::vector<cpu_set_t> *saved) {
+	cpu_set_t set;
+	std::vector<int> cpus;
+	if (sched_getaffinity(0, sizeof(set), &set) != 0)
+		return 0;
+	for (size_t i = 0; i < aggressors.size(); i++)
+		if (aggressors[i] >= 0 && aggressors[i] < CPU_SETSIZE)
+			CPU_CLR(aggressors[i], &set);
+	for (int c = 0; c < CPU_SETSIZE; c++)
+		if (CPU_ISSET(c, &set))
+			cpus.push_back(c);
+	#ifdef _OPENMP
+	int team = omp_get_max_threads() < (int)cpus.size() ? omp_get_max_threads() : cpus.size();
+	omp_set_dynamic(0);
+	#else
+	int team = cpus.empty() ? 0 : 1;
+	#endif
+	if (team == 0)
+		return 0;
+	saved->resize(team);
+	int pinned = 0;
+	#pragma omp parallel num_threads(team) reduction(+:pinned)
+	{
+		#ifdef _OPENMP
+		int t = omp_get_thread_num();
+		#else
+		int t = 0;
+		#endif
+		cpu_set_t one;
+		CPU_ZERO(&one);
+		CPU_SET(cpus[t], &one);
+		sched_getaffinity(0, sizeof((*saved)[t]), &(*saved)[t]);
+		pinned = sched_setaffinity(0, sizeof(one), &one) == 0;
+	}
+	if (pinned < team)
+		fprintf(stderr, "WARNING: only %d of %d victim threads could be pinned\n", pinned, team);
+	return team;
+}
+
+/* Every team thread back on the mask it had before victim_pin() */
+static void victim_unpin(const std::vector<cpu_set_t> &saved) {
+	#pragma omp parallel num_threads(saved.size())
+	{
+		#ifdef _OPENMP
+		int t = omp_get_thread_num();
+		#else
+		int t = 0;
+		#endif
+		sched_setaffinity(0, sizeof(saved[t]), &saved[t]);
+	}
+}
+
+bool interference_parse_pattern(const char *name, AggressorPattern *p) {
+	for (int i = 0; i < 3; i++)
+		if (strcmp(name, pattern_names[i]) == 0) {
+			*p = (AggressorPattern)i;
+			return true;
+		}
+	return false;
+}
+
+const char *interference_pattern_name(AggressorPattern p) {
+	return pattern_names[p];
+}
+
+int interference_run(const InterferenceConfig &icfg, const BandConfig &cfg, BandArrays *arr,
+                     std::vector<InterferenceLevel> *levels) {
+	std::vector<Aggressor> ags(icfg.cpus.size());
+	std::vector<cpu_set_t> saved;
+	size_t *chase = latency_buffer(icfg.latency_bytes);
+	int rc = 0;
+
+	if (chase == NULL)
+		return -1;
+	/* The victim must not share a CPU with any aggressor */
+	BandConfig victim = cfg;
+	victim.threads = victim_pin(icfg.cpus, &saved);
+	victim.exit_after_roi = false;
+	if (victim.threads == 0) {
+		fprintf(stderr, "No CPU left for the victim team outside --aggressor-cpus\n");
+		free(chase);
+		return -1;
+	}
+	fprintf(stderr, "Interference: victim team of %d threads, pinned off the aggressor CPUs\n",
+		victim.threads);
+	for (size_t i = 0; i < ags.size(); i++) {
+		ags[i].pattern = icfg.pattern;
+		ags[i].bytes = icfg.aggressor_bytes * (icfg.pattern == AGGRESSOR_TRIAD ? 3 : 1);
+		ags[i].buf = (char *)malloc(ags[i].bytes);
+		if (ags[i].buf == NULL) {
+			rc = -1;
+			break;
+		}
+		memset(ags[i].buf, 0, ags[i].bytes);
+	}
+
+	levels->clear();
+	for (int level = 0; rc == 0 && level <= (int)icfg.cpus.size(); level++) {
+		InterferenceLevel lv;
+		RunResult res;
+		lv.aggressors = level;
+		/* band_validate() expects ntimes passes over fresh arrays */
+		if (level > 0)
+			band_reset(arr);
+		if (aggressors_start(ags, icfg.cpus, level) != 0) {
+			rc = -1;
+			break;
+		}
+		double t0 = timer_now();
+		struct timespec ramp = { 0, AGGRESSOR_RAMP_MS * 1000000L };
+		nanosleep(&ramp, NULL);
+
+		band_measure(victim, arr, &res);
+		lv.latency_ns = latency_probe(chase);
+
+		uint64_t bytes = aggressors_stop(ags, level);
+		lv.aggressor_MBps = 1.0E-06 * bytes / (timer_now() - t0);
+		for (size_t j = 0; j < res.kernels.size(); j++) {
+			lv.kernels.push_back(res.kernels[j].name);
+			lv.median_MBps.push_back(1.0E-06 * res.kernels[j].bytes / res.kernels[j].stats.median);
+		}
+		lv.validation_errors = band_validate(*arr, victim.ntimes, NULL);
+		levels->push_back(lv);
+	}
+
+	for (size_t i = 0; i < ags.size(); i++)
+		free(ags[i].buf);
+	free(chase);
+	victim_unpin(saved);
+	return rc;
+}
+
+static double change_pct(double v, double base) {
+	return 100.0 * (v - base) / base;
+}
+
+static const char *kernel_label(const std::string &name) {
+	const StreamKernel *k = registry_find(name.c_str());
+	return k != NULL ? k->label : name.c_str();
+}
+
+void interference_print(FILE *fp, const InterferenceConfig &cfg,
+                        const std::vector<InterferenceLevel> &levels) {
+	if (levels.empty())
+		return;
+	const InterferenceLevel &base = levels[0];
+
+	fprintf(fp, "Interference: %s aggressors, %.0f MiB each, on CPUs",
+		interference_pattern_name(cfg.pattern), cfg.aggressor_bytes / (1024.0 * 1024.0));
+	for (size_t i = 0; i < cfg.cpus.size(); i++)
+		fprintf(fp, " %ld", cfg.cpus[i]);
+	fprintf(fp, "\nVictim median MB/s (change vs. no aggressors), load latency over %.0f MiB\n",
+		cfg.latency_bytes / (1024.0 * 1024.0));
+	fprintf(fp, "Aggr  ");
+	for (size_t j = 0; j < base.kernels.size(); j++)
+		fprintf(fp, "%-20s", kernel_label(base.kernels[j]));
+	fprintf(fp, "Latency ns         Aggressor MB/s\n");
+	for (size_t i = 0; i < levels.size(); i++) {
+		const InterferenceLevel &lv = levels[i];
+		fprintf(fp, "%4d  ", lv.aggressors);
+		for (size_t j = 0; j < lv.median_MBps.size(); j++)
+			fprintf(fp, "%9.1f (%+5.1f%%)  ", lv.median_MBps[j],
+				change_pct(lv.median_MBps[j], base.median_MBps[j]));
+		fprintf(fp, "%7.1f (%+6.1f%%)  %12.1f%s\n", lv.latency_ns,
+			change_pct(lv.latency_ns, base.latency_ns), lv.aggressor_MBps,
+			lv.validation_errors ? "  (failed validation)" : "");
+	}
+}
+
+int interference_write_json(const char *path, const InterferenceConfig &cfg,
+                            const std::vector<InterferenceLevel> &levels) {
+	FILE *fp = result_open(path);
+	if (fp == NULL)
+		return -1;
+	fprintf(fp, "{\n  \"pattern\": \"%s\",\n  \"aggressor_bytes\": %zu,\n"
+		"  \"latency_bytes\": %zu,\n  \"aggressor_cpus\": [",
+		interference_pattern_name(cfg.pattern), cfg.aggressor_bytes, cfg.latency_bytes);
+	for (size_t i = 0; i < cfg.cpus.size(); i++)
+		fprintf(fp, "%s%ld", i ? ", " : "", cfg.cpus[i]);
+	fprintf(fp, "],\n  \"levels\": [\n");
+	for (size_t i = 0; i < levels.size(); i++) {
+		const InterferenceLevel &lv = levels[i];
+		fprintf(fp, "    {\"aggressors\": %d", lv.aggressors);
+		for (size_t j = 0; j < lv.kernels.size(); j++)
+			fprintf(fp, ", \"%s_MBps\": %.3f", lv.kernels[j].c_str(), lv.median_MBps[j]);
+		fprintf(fp, ", \"latency_ns\": %.3f, \"aggressor_MBps\": %.3f, \"validation_errors\": %d}%s\n",
+			lv.latency_ns, lv.aggressor_MBps, lv.validation_errors,
+			i + 1 < levels.size() ? "," : "");
+	}
+	fprintf(fp, "  ]\n}\n");
+	return result_close(fp);
+}
+
+int interference_write_csv(const char *path, const InterferenceConfig &cfg,
+                           const std::vector<InterferenceLevel> &levels) {
+	FILE *fp = result_open(path);
+	if (fp == NULL)
+		return -1;
+	fprintf(fp, "pattern,aggressors");
+	if (!levels.empty())
+		for (size_t j = 0; j < levels[0].kernels.size(); j++)
+			fprintf(fp, ",%s_MBps", levels[0].kernels[j].c_str());
+	fprintf(fp, ",latency_ns,aggressor_MBps,validation_errors\n");
+	for (size_t i = 0; i < levels.size(); i++) {
+		const InterferenceLevel &lv = levels[i];
+		fprintf(fp, "%s,%d", interference_pattern_name(cfg.pattern), lv.aggressors);
+		for (size_t j = 0; j < lv.median_MBps.size(); j++)
+			fprintf(fp, ",%.3f", lv.median_MBps[j]);
+		fprintf(fp, ",%.3f,%.3f,%d\n", lv.latency_ns, lv.aggressor_MBps, lv.validation_errors);
+	}
+	return result_close(fp);
+}
@@ -0,0 +1,82 @@
+/*-----------------------------------------------------------------------*/
+/* Noisy-neighbour interference mode.                                    */
+/*                                                                       */
+/* The STREAM kernels and any extra registry kernels (the "victim") run */
+/* through band_measure() on the OpenMP team, pinned to the CPUs the     */
+/* aggressors leave free, while aggressor threads, each                  */
+/* pinned to its own CPU and working on its own buffers, run a           */
+/* memory-intensive pattern:                                             */
+/*   triad   the Triad kernel of the scalar set, streaming               */
+/*   random  read-modify-write of random cache lines                     */
+/*   thrash  one store per cache line, sweeping a buffer larger than     */
+/*           the LLC so the victim's lines keep getting evicted          */
+/* Intensity level k runs the first k aggressor CPUs. At every level     */
+/* the victim's median bandwidth per kernel and its dependent-load       */
+/* latency are measured and compared with level 0 (no aggressors).       */
+/*-----------------------------------------------------------------------*/
+#ifndef STREAM_INTERFERENCE_H
+#define STREAM_INTERFERENCE_H
+
+# include <stdio.h>
+# include <string>
+# include <vector>
+# include "bandstream.h"
+
+/* Buffer per aggressor (and per Triad array), MiB */
+#ifndef INTERFERENCE_AGGRESSOR_MIB
+#   define INTERFERENCE_AGGRESSOR_MIB	64
+#endif
+
+/* Pointer-chase buffer of the victim latency probe, MiB */
+#ifndef INTERFERENCE_LATENCY_MIB
+#   define INTERFERENCE_LATENCY_MIB	64
+#endif
+
+/* Dependent loads per latency probe */
+#ifndef INTERFERENCE_LATENCY_LOADS
+#   define INTERFERENCE_LATENCY_LOADS	(1 << 22)
+#endif
+
+enum AggressorPattern {
+	AGGRESSOR_TRIAD = 0,
+	AGGRESSOR_RANDOM,
+	AGGRESSOR_THRASH
+};
+
+struct InterferenceConfig {
+	AggressorPattern	pattern;
+	std::vector<long>	cpus;		/* aggressor CPUs, in activation order */
+	size_t			aggressor_bytes;
+	size_t			latency_bytes;
+};
+
+struct InterferenceLevel {
+	int		aggressors;
+	std::vector<std::string> kernels;	/* victim kernels, as timed */
+	std::vector<double> median_MBps;	/* victim, per kernel */
+	double		latency_ns;		/* victim, per dependent load */
+	double		aggressor_MBps;		/* all aggressors together */
+	int		validation_errors;	/* band_validate() of the victim arrays */
+};
+
+bool interference_parse_pattern(const char *name, AggressorPattern *p);
+const char *interference_pattern_name(AggressorPattern p);
+
+/*
+ * Run every level 0..icfg.cpus.size(): band_measure() of 'cfg' over the
+ * freshly allocated 'arr', on a team pinned off the aggressor CPUs, then
+ * band_validate(). The arrays are reset between levels.
+ */
+int interference_run(const InterferenceConfig &icfg, const BandConfig &cfg, BandArrays *arr,
+                     std::vector<InterferenceLevel> *levels);
+
+void interference_print(FILE *fp, const InterferenceConfig &cfg,
+                        const std::vector<InterferenceLevel> &levels);
+
+/* Write to 'path' ("-" for stdout); 0 on success */
+int interference_write_json(const char *path, const InterferenceConfig &cfg,
+                            const std::vector<InterferenceLevel> &levels);
+int interference_write_csv(const char *path, const InterferenceConfig &cfg,
+                           const std::vector<InterferenceLevel> &levels);
+
+#endif /* STREAM_INTERFERENCE_H */
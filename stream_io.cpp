@@ -0,0 +1,299 @@
+/*-----------------------------------------------------------------------*/
+/* File I/O streaming bandwidth, next to the memory numbers.             */
+/*-----------------------------------------------------------------------*/
+# include <stdint.h>
+# include <stdlib.h>
+# include <string.h>
+# include <errno.h>
+# include <fcntl.h>
+# include <unistd.h>
+# include <algorithm>
+# include <sys/mman.h>
+# include <sys/syscall.h>
+# include "stream_io.h"
+# include "stream_stats.h"
+# include "stream_timer.h"
+
+/* No liburing: the three syscalls and the ring layout are all we need */
+#if defined(__NR_io_uring_setup) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+# include <linux/io_uring.h>
+# define HAVE_IO_URING	1
+#endif
+#endif
+
+static const char *method_names[IO_NMETHODS] = { "buffered", "direct", "io_uring" };
+
+const char *io_method_name(IoMethod m) {
+	return method_names[m];
+}
+
+/* One pass: its duration and every I/O's latency */
+struct Pass {
+	double			seconds;
+	std::vector<double>	latency;
+};
+
+/* One I/O at a time; 0, else an errno value */
+static int sync_pass(int fd, bool write, char *buf, size_t bytes, size_t block, Pass *pass) {
+	double t0 = timer_now();
+	for (size_t off = 0; off < bytes; off += block) {
+		size_t len = std::min(block, bytes - off);
+		double t = timer_now();
+		ssize_t n = write ? pwrite(fd, buf + off, len, off) : pread(fd, buf + off, len, off);
+		if (n != (ssize_t)len)
+			return n < 0 ? errno : EIO;
+		pass->latency.push_back(timer_now() - t);
+	}
+	if (write && fdatasync(fd) != 0)
+		return errno;
+	pass->seconds = timer_now() - t0;
+	return 0;
+}
+
+#ifdef HAVE_IO_URING
+struct Uring {
+	int			fd;
+	unsigned		entries;
+	void			*sq_ptr, *cq_ptr;
+	size_t			sq_len, cq_len;
+	unsigned		*sq_head, *sq_tail, *sq_mask, *sq_array;
+	unsigned		*cq_head, *cq_tail, *cq_mask;
+	struct io_uring_sqe	*sqes;
+	struct io_uring_cqe	*cqes;
+};
+
+static void uring_exit(Uring *r) {
+	munmap(r->sqes, r->entries * sizeof(struct io_uring_sqe));
+	if (r->cq_ptr != r->sq_ptr)
+		munmap(r->cq_ptr, r->cq_len);
+	munmap(r->sq_ptr, r->sq_len);
+	close(r->fd);
+}
+
+/* 0, else an errno value (ENOSYS/EPERM where io_uring is unavailable) */
+static int uring_init(Uring *r, unsigned entries) {
+	struct io_uring_params p;
+	memset(&p, 0, sizeof(p));
+	r->fd = syscall(__NR_io_uring_setup, entries, &p);
+	if (r->fd < 0)
+		return errno;
+	r->entries = p.sq_entries;
+	r->sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+	r->cq_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+	if (p.features & IORING_FEAT_SINGLE_MMAP)
+		r->sq_len = r->cq_len = std::max(r->sq_len, r->cq_len);
+	r->sq_ptr = mmap(NULL, r->sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+	                 r->fd, IORING_OFF_SQ_RING);
+	r->cq_ptr = (p.features & IORING_FEAT_SINGLE_MMAP) ? r->sq_ptr :
+		mmap(NULL, r->cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+		     r->fd, IORING_OFF_CQ_RING);
+	r->sqes = (struct io_uring_sqe *)mmap(NULL, p.sq_entries * sizeof(struct io_uring_sqe),
+		PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQES);
+	if (r->sq_ptr == MAP_FAILED || r->cq_ptr == MAP_FAILED || r->sqes == MAP_FAILED) {
+		int e = errno;
+		close(r->fd);
+		return e;
+	}
+	char *sq = (char *)r->sq_ptr, *cq = (char *)r->cq_ptr;
+	r->sq_head = (unsigned *)(sq + p.sq_off.head);
+	r->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+	r->sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+	r->sq_array = (unsigned *)(sq + p.sq_off.array);
+	r->cq_head = (unsigned *)(cq + p.cq_off.head);
+	r->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+	r->cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+	r->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+	return 0;
+}
+
+/* Keep up to 'depth' block I/Os in flight until all of [0, bytes) is done */
+static int uring_pass(Uring *r, int fd, bool write, char *buf, size_t bytes, size_t block,
+                      unsigned depth, Pass *pass) {
+	const size_t nios = (bytes + block - 1) / block;
+	std::vector<double> issued(nios);
+	size_t next = 0, done = 0;
+	unsigned inflight = 0;
+	double t0 = timer_now();
+	while (done < nios) {
+		unsigned tail = *r->sq_tail, queued = 0;
+		while (next < nios && inflight + queued < depth) {
+			unsigned idx = tail & *r->sq_mask;
+			struct io_uring_sqe *sqe = &r->sqes[idx];
+			size_t off = next * block;
+			memset(sqe, 0, sizeof(*sqe));
+			sqe->opcode = write ? IORING_OP_WRITE : IORING_OP_READ;
+			sqe->fd = fd;
+			sqe->addr = (uintptr_t)(buf + off);
+			sqe->len = std::min(block, bytes - off);
+			sqe->off = off;
+			sqe->user_data = next;
+			r->sq_array[idx] = idx;
+			issued[next++] = timer_now();
+			tail++;
+			queued++;
+		}
+		__atomic_store_n(r->sq_tail, tail, __ATOMIC_RELEASE);
+		if (syscall(__NR_io_uring_enter, r->fd, queued, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0
+		    && errno != EINTR)
+			return errno;
+		inflight += queued;
+
+		unsigned head = *r->cq_head;
+		while (head != __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE)) {
+			struct io_uring_cqe *cqe = &r->cqes[head & *r->cq_mask];
+			size_t i = cqe->user_data;
+			if (cqe->res != (int)std::min(block, bytes - i * block))
+				return cqe->res < 0 ? -cqe->res : EIO;
+			pass->latency.push_back(timer_now() - issued[i]);
+			head++;
+			inflight--;
+			done++;
+		}
+		__atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+	}
+	if (write && fdatasync(fd) != 0)
+		return errno;
+	pass->seconds = timer_now() - t0;
+	return 0;
+}
+#endif /* HAVE_IO_URING */
+
+/* Refusals that mean "not here", rather than a failed run */
+static bool unsupported(int e) {
+	return e == EINVAL || e == ENOSYS || e == EPERM || e == EOPNOTSUPP;
+}
+
+static int run_method(IoMethod m, const IoConfig &cfg, const char *path, char *src, char *dst,
+                      size_t bytes, IoResult *wr, IoResult *rd) {
+	int fd = -1, e = 0;
+	wr->direct = rd->direct = m != IO_BUFFERED;
+	if (m != IO_BUFFERED) {
+		fd = open(path, O_RDWR | O_DIRECT);
+		/* io_uring still has something to say about a buffered file */
+		if (fd < 0 && errno == EINVAL && m == IO_URING)
+			wr->direct = rd->direct = false;
+		else if (fd < 0)
+			return errno;
+	}
+	if (fd < 0 && (fd = open(path, O_RDWR)) < 0)
+		return errno;
+
+	#ifdef HAVE_IO_URING
+	Uring ring = Uring();
+	if (m == IO_URING && (e = uring_init(&ring, cfg.depth)) != 0) {
+		close(fd);
+		return e;
+	}
+	#else
+	if (m == IO_URING) {
+		close(fd);
+		return ENOSYS;
+	}
+	#endif
+
+	std::vector<double> rate[2], latency[2];
+	for (int k = 0; k < IO_REPEAT && e == 0; k++)
+		for (int w = 1; w >= 0 && e == 0; w--) {
+			Pass pass;
+			char *buf = w ? src : dst;
+			if (!w) {
+				memset(dst, 0, bytes);
+				if (!rd->direct)
+					posix_fadvise(fd, 0, bytes, POSIX_FADV_DONTNEED);
+			}
+			#ifdef HAVE_IO_URING
+			if (m == IO_URING)
+				e = uring_pass(&ring, fd, w, buf, bytes, cfg.block, cfg.depth, &pass);
+			else
+			#endif
+				e = sync_pass(fd, w, buf, bytes, cfg.block, &pass);
+			if (e != 0)
+				break;
+			rate[w].push_back(1.0E-09 * bytes / pass.seconds);
+			latency[w].insert(latency[w].end(), pass.latency.begin(), pass.latency.end());
+			if (!w && memcmp(dst, src, bytes) != 0)
+				rd->errors++;
+		}
+	#ifdef HAVE_IO_URING
+	if (m == IO_URING)
+		uring_exit(&ring);
+	#endif
+	close(fd);
+	if (e != 0)
+		return e;
+
+	IoResult *res[2] = { rd, wr };
+	for (int w = 0; w < 2; w++) {
+		std::sort(latency[w].begin(), latency[w].end());
+		res[w]->GBps = stats_median(&rate[w][0], rate[w].size());
+		res[w]->lat_median_us = 1.0E+06 * stats_percentile_sorted(&latency[w][0], latency[w].size(), 0.5);
+		res[w]->lat_p99_us = 1.0E+06 * stats_percentile_sorted(&latency[w][0], latency[w].size(), 0.99);
+	}
+	return 0;
+}
+
+int io_run(const IoConfig &cfg, const void *src, void *dst, size_t bytes,
+           std::vector<IoResult> *results, std::string *err) {
+	/* The aligned interior of both buffers, in whole IO_ALIGN units */
+	uintptr_t s = ((uintptr_t)src + IO_ALIGN - 1) & ~(uintptr_t)(IO_ALIGN - 1);
+	uintptr_t d = ((uintptr_t)dst + IO_ALIGN - 1) & ~(uintptr_t)(IO_ALIGN - 1);
+	size_t skip = std::max(s - (uintptr_t)src, d - (uintptr_t)dst);
+	size_t len = bytes > skip ? (bytes - skip) & ~(size_t)(IO_ALIGN - 1) : 0;
+	if (len == 0) {
+		*err = "arrays too small for aligned I/O";
+		return -1;
+	}
+
+	std::string path = cfg.dir + "/band_stream_io.XXXXXX";
+	int fd = mkstemp(&path[0]);
+	if (fd < 0) {
+		*err = "cannot create " + path + ": " + strerror(errno);
+		return -1;
+	}
+	close(fd);
+
+	results->clear();
+	int rc = 0;
+	for (int m = 0; m < IO_NMETHODS && rc == 0; m++) {
+		IoResult wr, rd;
+		memset(&wr, 0, sizeof(wr));
+		wr.method = (IoMethod)m;
+		wr.write = true;
+		wr.supported = true;
+		wr.bytes = len;
+		rd = wr;
+		rd.write = false;
+		int e = run_method((IoMethod)m, cfg, path.c_str(), (char *)s, (char *)d, len, &wr, &rd);
+		if (e != 0 && unsupported(e)) {
+			wr.supported = rd.supported = false;
+		} else if (e != 0) {
+			*err = std::string(io_method_name((IoMethod)m)) + " I/O on " + path + ": " + strerror(e);
+			rc = -1;
+			break;
+		}
+		results->push_back(wr);
+		results->push_back(rd);
+	}
+	unlink(path.c_str());
+	return rc;
+}
+
+void io_print(FILE *fp, const IoConfig &cfg, const std::vector<IoResult> &results, double memory_GBps) {
+	fprintf(fp, "File I/O in %s: %.1f MiB per pass, %zu KiB blocks, io_uring depth %d, median of %d passes\n",
+		cfg.dir.c_str(), results.empty() ? 0.0 : results[0].bytes / 1048576.0,
+		cfg.block / 1024, cfg.depth, IO_REPEAT);
+	fprintf(fp, "Method     Dir    O_DIRECT      GB/s   Median us     p99 us   Errors\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		const IoResult &r = results[i];
+		if (!r.supported) {
+			fprintf(fp, "%-10s %-6s not supported here\n", io_method_name(r.method),
+				r.write ? "write" : "read");
+			continue;
+		}
+		fprintf(fp, "%-10s %-6s %8s %9.3f %11.1f %10.1f %8d\n", io_method_name(r.method),
+			r.write ? "write" : "read", r.direct ? "yes" : "no", r.GBps,
+			r.lat_median_us, r.lat_p99_us, r.errors);
+	}
+	fprintf(fp, "Memory     copy            %9.3f\n", memory_GBps);
+}
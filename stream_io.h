@@ -0,0 +1,80 @@
+/*-----------------------------------------------------------------------*/
+/* File I/O streaming bandwidth, next to the memory numbers.             */
+/*                                                                       */
+/* After the timed loop one STREAM array is written to a scratch file in */
+/* the given directory and read back into another one, block by block:   */
+/*   buffered   pwrite/pread through the page cache, one I/O at a time   */
+/*   direct     the same with O_DIRECT                                   */
+/*   io_uring   O_DIRECT (buffered where the filesystem refuses it) with */
+/*              up to 'depth' I/Os in flight, via the raw syscalls       */
+/* Writes end with fdatasync() inside the timed pass; buffered reads     */
+/* start with the file dropped from the page cache. O_DIRECT needs       */
+/* IO_ALIGN aligned memory, so the I/O covers the aligned interior of    */
+/* the arrays. Every read is compared with what was written.             */
+/*-----------------------------------------------------------------------*/
+#ifndef STREAM_IO_H
+#define STREAM_IO_H
+
+# include <stdio.h>
+# include <stdint.h>
+# include <string>
+# include <vector>
+
+/* Default --io-block, in KiB */
+#ifndef IO_BLOCK_KIB
+#   define IO_BLOCK_KIB	1024
+#endif
+
+/* Default --io-depth */
+#ifndef IO_DEPTH
+#   define IO_DEPTH	32
+#endif
+
+/* Write + read passes per method */
+#ifndef IO_REPEAT
+#   define IO_REPEAT	3
+#endif
+
+/* Buffer, offset and length alignment of O_DIRECT */
+#ifndef IO_ALIGN
+#   define IO_ALIGN	4096
+#endif
+
+struct IoConfig {
+	std::string	dir;		/* scratch file goes here */
+	size_t		block;		/* bytes per I/O, a multiple of IO_ALIGN */
+	int		depth;		/* io_uring I/Os in flight */
+};
+
+enum IoMethod {
+	IO_BUFFERED = 0,
+	IO_DIRECT,
+	IO_URING,
+	IO_NMETHODS
+};
+
+struct IoResult {
+	IoMethod	method;
+	bool		write;
+	bool		supported;	/* false: the kernel or filesystem refused */
+	bool		direct;		/* ran on an O_DIRECT descriptor */
+	size_t		bytes;		/* per pass */
+	double		GBps;		/* median over passes */
+	double		lat_median_us;	/* per I/O, over all passes */
+	double		lat_p99_us;
+	int		errors;		/* reads that did not return what was written */
+};
+
+const char *io_method_name(IoMethod m);
+
+/*
+ * Every method over 'bytes' of src (written) and dst (read into; its
+ * contents are lost). 0 on success, else -1 and *err says why.
+ */
+int io_run(const IoConfig &cfg, const void *src, void *dst, size_t bytes,
+           std::vector<IoResult> *results, std::string *err);
+
+/* 'memory_GBps' is printed alongside for reference */
+void io_print(FILE *fp, const IoConfig &cfg, const std::vector<IoResult> &results, double memory_GBps);
+
+#endif /* STREAM_IO_H */
@@ -0,0 +1,182 @@
+/*-----------------------------------------------------------------------*/
+/* ISA-specific implementations of the four STREAM kernels.              */
+/*-----------------------------------------------------------------------*/
+# include <string.h>
+# include "stream_kernels.h"
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
+KernelParams kernel_params = { 8, 0, 0, true };
+
+/* --- scalar: the reference loops --- */
+
+static bool scalar_available() {
+	return true;
+}
+
+static void scalar_copy(STREAM_TYPE *c, const STREAM_TYPE *a, ssize_t n) {
+	for (ssize_t j=0; j<n; j++)
+	    c[j] = a[j];
+}
+
+static void scalar_scale(STREAM_TYPE *b, const STREAM_TYPE *c, STREAM_TYPE scalar, ssize_t n) {
+	for (ssize_t j=0; j<n; j++)
+	    b[j] = scalar*c[j];
+}
+
+static void scalar_add(STREAM_TYPE *c, const STREAM_TYPE *a, const STREAM_TYPE *b, ssize_t n) {
+	for (ssize_t j=0; j<n; j++)
+	    c[j] = a[j]+b[j];
+}
+
+static void scalar_triad(STREAM_TYPE *a, const STREAM_TYPE *b, const STREAM_TYPE *c,
+                         STREAM_TYPE scalar, ssize_t n) {
+	for (ssize_t j=0; j<n; j++)
+	    a[j] = b[j]+scalar*c[j];
+}
+
+const KernelSet kernel_set_scalar = {
+	"scalar", "plain C loops (compiler auto-vectorised)",
+	scalar_available, scalar_copy, scalar_scale, scalar_add, scalar_triad
+};
+
+/*
+ * --- prefetch: the reference loops, one cache line at a time, with an
+ * explicit __builtin_prefetch of every stream 'prefetch_lines' ahead ---
+ *
+ * Loaded streams get a read hint, the stored stream a write hint (unless
+ * prefetch_write is off). The locality hint has to be a compile-time
+ * constant, so each kernel is instantiated for 0..3 and picked per call.
+ */
+
+# define PF_LINE	((ssize_t)(CACHE_LINE_BYTES / sizeof(STREAM_TYPE)))
+
+# define PF_LOOP(n, prefetch, body)                                        \
+	const ssize_t pf = kernel_params.prefetch_lines * PF_LINE;            \
+	const bool pw = kernel_params.prefetch_write;                         \
+	ssize_t j = 0;                                                        \
+	for (; j + PF_LINE <= (n); j += PF_LINE) {                            \
+		if (pf > 0)                                                       \
+			prefetch                                                      \
+		for (ssize_t i = j; i < j + PF_LINE; i++)                         \
+			body;                                                         \
+	}                                                                     \
+	for (ssize_t i = j; i < (n); i++)                                     \
+		body;
+
+template <int LOC>
+static void pf_copy(STREAM_TYPE *c, const STREAM_TYPE *a, ssize_t n) {
+	PF_LOOP(n, {
+		__builtin_prefetch(a + j + pf, 0, LOC);
+		if (pw) __builtin_prefetch(c + j + pf, 1, LOC);
+	}, c[i] = a[i])
+}
+
+template <int LOC>
+static void pf_scale(STREAM_TYPE *b, const STREAM_TYPE *c, STREAM_TYPE scalar, ssize_t n) {
+	PF_LOOP(n, {
+		__builtin_prefetch(c + j + pf, 0, LOC);
+		if (pw) __builtin_prefetch(b + j + pf, 1, LOC);
+	}, b[i] = scalar*c[i])
+}
+
+template <int LOC>
+static void pf_add(STREAM_TYPE *c, const STREAM_TYPE *a, const STREAM_TYPE *b, ssize_t n) {
+	PF_LOOP(n, {
+		__builtin_prefetch(a + j + pf, 0, LOC);
+		__builtin_prefetch(b + j + pf, 0, LOC);
+		if (pw) __builtin_prefetch(c + j + pf, 1, LOC);
+	}, c[i] = a[i]+b[i])
+}
+
+template <int LOC>
+static void pf_triad(STREAM_TYPE *a, const STREAM_TYPE *b, const STREAM_TYPE *c,
+                     STREAM_TYPE scalar, ssize_t n) {
+	PF_LOOP(n, {
+		__builtin_prefetch(b + j + pf, 0, LOC);
+		__builtin_prefetch(c + j + pf, 0, LOC);
+		if (pw) __builtin_prefetch(a + j + pf, 1, LOC);
+	}, a[i] = b[i]+scalar*c[i])
+}
+
+# define PF_DISPATCH(fn, args)                                            \
+	switch (kernel_params.prefetch_locality) {                            \
+	case 0:  fn<0> args; break;                                           \
+	case 1:  fn<1> args; break;                                           \
+	case 2:  fn<2> args; break;                                           \
+	default: fn<3> args; break;                                           \
+	}
+
+static void prefetch_copy(STREAM_TYPE *c, const STREAM_TYPE *a, ssize_t n) {
+	PF_DISPATCH(pf_copy, (c, a, n))
+}
+
+static void prefetch_scale(STREAM_TYPE *b, const STREAM_TYPE *c, STREAM_TYPE scalar, ssize_t n) {
+	PF_DISPATCH(pf_scale, (b, c, scalar, n))
+}
+
+static void prefetch_add(STREAM_TYPE *c, const STREAM_TYPE *a, const STREAM_TYPE *b, ssize_t n) {
+	PF_DISPATCH(pf_add, (c, a, b, n))
+}
+
+static void prefetch_triad(STREAM_TYPE *a, const STREAM_TYPE *b, const STREAM_TYPE *c,
+                           STREAM_TYPE scalar, ssize_t n) {
+	PF_DISPATCH(pf_triad, (a, b, c, scalar, n))
+}
+
+const KernelSet kernel_set_prefetch = {
+	"prefetch", "plain C loops with __builtin_prefetch (--prefetch lines ahead)",
+	scalar_available, prefetch_copy, prefetch_scale, prefetch_add, prefetch_triad
+};
+
+/* --- registry --- */
+
+static const KernelSet *const kernel_sets[] = {
+	&kernel_set_scalar,
+	&kernel_set_prefetch,
+	&kernel_set_rvv,
+	&kernel_set_rvv_strided,
+	&kernel_set_rvv_indexed,
+	&kernel_set_neon,
+	&kernel_set_neon_ldp,
+	&kernel_set_sve,
+};
+
+# define NUM_KERNEL_SETS	(sizeof(kernel_sets)/sizeof(kernel_sets[0]))
+
+const KernelSet *kernel_set_find(const char *name) {
+	for (size_t i = 0; i < NUM_KERNEL_SETS; i++)
+		if (strcmp(kernel_sets[i]->name, name) == 0)
+			return kernel_sets[i];
+	return NULL;
+}
+
+const KernelSet *kernel_set_default() {
+	return &kernel_set_scalar;
+}
+
+void kernel_set_list(FILE *fp) {
+	for (size_t i = 0; i < NUM_KERNEL_SETS; i++)
+		fprintf(fp, "    %-16s %s%s\n", kernel_sets[i]->name,
+			kernel_sets[i]->description,
+			kernel_sets[i]->available() ? "" : " [unavailable]");
+}
+
+void kernel_chunk(ssize_t n, ssize_t *lo, ssize_t *hi) {
+	#ifdef _OPENMP
+	ssize_t tid = omp_get_thread_num();
+	ssize_t nth = omp_get_num_threads();
+	#else
+	ssize_t tid = 0, nth = 1;
+	#endif
+	const ssize_t align = 64 / sizeof(STREAM_TYPE);
+	ssize_t per = (n + nth - 1) / nth;
+	per = (per + align - 1) / align * align;
+	*lo = tid * per;
+	*hi = *lo + per;
+	if (*lo > n)
+		*lo = n;
+	if (*hi > n)
+		*hi = n;
+}
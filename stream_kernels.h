@@ -0,0 +1,72 @@
+/*-----------------------------------------------------------------------*/
+/* ISA-specific implementations of the four STREAM kernels.              */
+/*                                                                       */
+/* A KernelSet provides Copy/Scale/Add/Triad over one contiguous chunk   */
+/* of the arrays. main() splits the arrays into one chunk per OpenMP     */
+/* thread (kernel_chunk) and calls the selected set, so every variant    */
+/* shares the same threading, timing and ROI code. "scalar" is the plain */
+/* C loops of the reference code and is always available.                */
+/*-----------------------------------------------------------------------*/
+#ifndef STREAM_KERNELS_H
+#define STREAM_KERNELS_H
+
+# include <stdio.h>
+# include <sys/types.h>
+
+#ifndef STREAM_TYPE
+#define STREAM_TYPE double
+#endif
+
+/* Prefetch distances are counted in lines of this size */
+#ifndef CACHE_LINE_BYTES
+#   define CACHE_LINE_BYTES	64
+#endif
+
+/* Run-time knobs shared by the variants that need them */
+struct KernelParams {
+	ssize_t	stride;		/* elements; strided variants */
+	ssize_t	prefetch_lines;	/* software prefetch distance, 0 = none */
+	int	prefetch_locality;	/* __builtin_prefetch locality hint, 0..3 */
+	bool	prefetch_write;	/* also prefetch the stored stream for writing */
+};
+
+extern KernelParams kernel_params;
+
+struct KernelSet {
+	const char	*name;
+	const char	*description;
+	bool		(*available)();	/* compiled in *and* supported by this CPU */
+	void		(*copy) (STREAM_TYPE *c, const STREAM_TYPE *a, ssize_t n);
+	void		(*scale)(STREAM_TYPE *b, const STREAM_TYPE *c, STREAM_TYPE scalar, ssize_t n);
+	void		(*add)  (STREAM_TYPE *c, const STREAM_TYPE *a, const STREAM_TYPE *b, ssize_t n);
+	void		(*triad)(STREAM_TYPE *a, const STREAM_TYPE *b, const STREAM_TYPE *c,
+			         STREAM_TYPE scalar, ssize_t n);
+};
+
+/* Look up a variant by name; NULL if unknown */
+const KernelSet *kernel_set_find(const char *name);
+
+/* The default variant: "scalar" */
+const KernelSet *kernel_set_default();
+
+/* One line per variant, marking the ones this machine cannot run */
+void kernel_set_list(FILE *fp);
+
+/*
+ * This thread's [lo, hi) share of n elements under the current OpenMP
+ * team. Boundaries fall on 64-byte multiples so vector variants start
+ * every chunk on a cache-line boundary whenever the arrays are aligned.
+ */
+void kernel_chunk(ssize_t n, ssize_t *lo, ssize_t *hi);
+
+/* Variant tables provided by the per-ISA translation units */
+extern const KernelSet kernel_set_scalar;
+extern const KernelSet kernel_set_prefetch;
+extern const KernelSet kernel_set_rvv;
+extern const KernelSet kernel_set_rvv_strided;
+extern const KernelSet kernel_set_rvv_indexed;
+extern const KernelSet kernel_set_neon;
+extern const KernelSet kernel_set_neon_ldp;
+extern const KernelSet kernel_set_sve;
+
+#endif /* STREAM_KERNELS_H */
@@ -0,0 +1,345 @@
+/*-----------------------------------------------------------------------*/
+/* Hand-written AArch64 STREAM kernels for the AARCH64 target.           */
+/*                                                                       */
+/*   neon      ld1/st1 {v0-v3} (the _x4 intrinsics), 64 bytes per step    */
+/*   neon-ldp  ldp/stp of q-register pairs, 64 bytes per step            */
+/*   sve       vector-length agnostic, predicated with whilelt           */
+/* All three honour --prefetch: every step issues prfm for the lines     */
+/* kernel_params.prefetch_lines ahead (PLDL1STRM for the streams that    */
+/* are read, PSTL1STRM for the one that is written).                     */
+/*-----------------------------------------------------------------------*/
+# include "stream_kernels.h"
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+# include <stdint.h>
+# include <sys/auxv.h>
+# include <arm_neon.h>
+#if defined(__ARM_FEATURE_SVE)
+# include <arm_sve.h>
+#endif
+
+/* Elements per 64-byte step */
+# define STEP	((ssize_t)(CACHE_LINE_BYTES / sizeof(STREAM_TYPE)))
+
+static inline ssize_t prefetch_elems() {
+	return kernel_params.prefetch_lines * STEP;
+}
+
+template <typename T> struct Neon;
+
+template <> struct Neon<double> {
+	typedef float64x2_t   vec;
+	typedef float64x2x4_t vec4;
+	static vec4 load4(const double *p) { return vld1q_f64_x4(p); }
+	static void store4(double *p, vec4 v) { vst1q_f64_x4(p, v); }
+	static vec mul(vec v, double s) { return vmulq_n_f64(v, s); }
+	static vec add(vec x, vec y) { return vaddq_f64(x, y); }
+	/* acc + x*s */
+	static vec fma(vec acc, vec x, double s) { return vfmaq_n_f64(acc, x, s); }
+};
+
+template <> struct Neon<float> {
+	typedef float32x4_t   vec;
+	typedef float32x4x4_t vec4;
+	static vec4 load4(const float *p) { return vld1q_f32_x4(p); }
+	static void store4(float *p, vec4 v) { vst1q_f32_x4(p, v); }
+	static vec mul(vec v, float s) { return vmulq_n_f32(v, s); }
+	static vec add(vec x, vec y) { return vaddq_f32(x, y); }
+	static vec fma(vec acc, vec x, float s) { return vfmaq_n_f32(acc, x, s); }
+};
+
+typedef Neon<STREAM_TYPE> N;
+
+static bool neon_available() {
+	return true;
+}
+
+/* --- neon: ld1/st1 x4 --- */
+
+static void neon_copy(STREAM_TYPE *c, const STREAM_TYPE *a, ssize_t n) {
+	const ssize_t pf = prefetch_elems();
+	ssize_t j = 0;
+	for (; j + STEP <= n; j += STEP) {
+		if (pf) {
+			__builtin_prefetch(a + j + pf, 0, 0);
+			__builtin_prefetch(c + j + pf, 1, 0);
+		}
+		N::store4(c + j, N::load4(a + j));
+	}
+	for (; j < n; j++)
+	    c[j] = a[j];
+}
+
+static void neon_scale(STREAM_TYPE *b, const STREAM_TYPE *c, STREAM_TYPE scalar, ssize_t n) {
+	const ssize_t pf = prefetch_elems();
+	ssize_t j = 0;
+	for (; j + STEP <= n; j += STEP) {
+		if (pf) {
+			__builtin_prefetch(c + j + pf, 0, 0);
+			__builtin_prefetch(b + j + pf, 1, 0);
+		}
+		N::vec4 v = N::load4(c + j);
+		for (int r = 0; r < 4; r++)
+			v.val[r] = N::mul(v.val[r], scalar);
+		N::store4(b + j, v);
+	}
+	for (; j < n; j++)
+	    b[j] = scalar*c[j];
+}
+
+static void neon_add(STREAM_TYPE *c, const STREAM_TYPE *a, const STREAM_TYPE *b, ssize_t n) {
+	const ssize_t pf = prefetch_elems();
+	ssize_t j = 0;
+	for (; j + STEP <= n; j += STEP) {
+		if (pf) {
+			__builtin_prefetch(a + j + pf, 0, 0);
+			__builtin_prefetch(b + j + pf, 0, 0);
+			__builtin_prefetch(c + j + pf, 1, 0);
+		}
+		N::vec4 x = N::load4(a + j);
+		N::vec4 y = N::load4(b + j);
+		for (int r = 0; r < 4; r++)
+			x.val[r] = N::add(x.val[r], y.val[r]);
+		N::store4(c + j, x);
+	}
+	for (; j < n; j++)
+	    c[j] = a[j]+b[j];
+}
+
+static void neon_triad(STREAM_TYPE *a, const STREAM_TYPE *b, const STREAM_TYPE *c,
+                       STREAM_TYPE scalar, ssize_t n) {
+	const ssize_t pf = prefetch_elems();
+	ssize_t j = 0;
+	for (; j + STEP <= n; j += STEP) {
+		if (pf) {
+			__builtin_prefetch(b + j + pf, 0, 0);
+			__builtin_prefetch(c + j + pf, 0, 0);
+			__builtin_prefetch(a + j + pf, 1, 0);
+		}
+		N::vec4 x = N::load4(b + j);
+		N::vec4 y = N::load4(c + j);
+		for (int r = 0; r < 4; r++)
+			x.val[r] = N::fma(x.val[r], y.val[r], scalar);
+		N::store4(a + j, x);
+	}
+	for (; j < n; j++)
+	    a[j] = b[j]+scalar*c[j];
+}
+
+/* --- neon-ldp: explicit ldp/stp of q-register pairs --- */
+
+static inline void ldp(const STREAM_TYPE *p, N::vec &x, N::vec &y) {
+	__asm__ __volatile__("ldp %q0, %q1, [%2]" : "=w"(x), "=w"(y) : "r"(p) : "memory");
+}
+
+static inline void stp(STREAM_TYPE *p, N::vec x, N::vec y) {
+	__asm__ __volatile__("stp %q0, %q1, [%2]" : : "w"(x), "w"(y), "r"(p) : "memory");
+}
+
+/* Elements in one q register */
+# define QELEMS	((ssize_t)(16 / sizeof(STREAM_TYPE)))
+
+static void ldp_copy(STREAM_TYPE *c, const STREAM_TYPE *a, ssize_t n) {
+	const ssize_t pf = prefetch_elems();
+	ssize_t j = 0;
+	for (; j + STEP <= n; j += STEP) {
+		N::vec x0, x1, x2, x3;
+		if (pf) {
+			__builtin_prefetch(a + j + pf, 0, 0);
+			__builtin_prefetch(c + j + pf, 1, 0);
+		}
+		ldp(a + j, x0, x1);
+		ldp(a + j + 2*QELEMS, x2, x3);
+		stp(c + j, x0, x1);
+		stp(c + j + 2*QELEMS, x2, x3);
+	}
+	for (; j < n; j++)
+	    c[j] = a[j];
+}
+
+static void ldp_scale(STREAM_TYPE *b, const STREAM_TYPE *c, STREAM_TYPE scalar, ssize_t n) {
+	const ssize_t pf = prefetch_elems();
+	ssize_t j = 0;
+	for (; j + STEP <= n; j += STEP) {
+		N::vec x0, x1, x2, x3;
+		if (pf) {
+			__builtin_prefetch(c + j + pf, 0, 0);
+			__builtin_prefetch(b + j + pf, 1, 0);
+		}
+		ldp(c + j, x0, x1);
+		ldp(c + j + 2*QELEMS, x2, x3);
+		stp(b + j, N::mul(x0, scalar), N::mul(x1, scalar));
+		stp(b + j + 2*QELEMS, N::mul(x2, scalar), N::mul(x3, scalar));
+	}
+	for (; j < n; j++)
+	    b[j] = scalar*c[j];
+}
+
+static void ldp_add(STREAM_TYPE *c, const STREAM_TYPE *a, const STREAM_TYPE *b, ssize_t n) {
+	const ssize_t pf = prefetch_elems();
+	ssize_t j = 0;
+	for (; j + STEP <= n; j += STEP) {
+		N::vec x0, x1, x2, x3, y0, y1, y2, y3;
+		if (pf) {
+			__builtin_prefetch(a + j + pf, 0, 0);
+			__builtin_prefetch(b + j + pf, 0, 0);
+			__builtin_prefetch(c + j + pf, 1, 0);
+		}
+		ldp(a + j, x0, x1);
+		ldp(a + j + 2*QELEMS, x2, x3);
+		ldp(b + j, y0, y1);
+		ldp(b + j + 2*QELEMS, y2, y3);
+		stp(c + j, N::add(x0, y0), N::add(x1, y1));
+		stp(c + j + 2*QELEMS, N::add(x2, y2), N::add(x3, y3));
+	}
+	for (; j < n; j++)
+	    c[j] = a[j]+b[j];
+}
+
+static void ldp_triad(STREAM_TYPE *a, const STREAM_TYPE *b, const STREAM_TYPE *c,
+                      STREAM_TYPE scalar, ssize_t n) {
+	const ssize_t pf = prefetch_elems();
+	ssize_t j = 0;
+	for (; j + STEP <= n; j += STEP) {
+		N::vec x0, x1, x2, x3, y0, y1, y2, y3;
+		if (pf) {
+			__builtin_prefetch(b + j + pf, 0, 0);
+			__builtin_prefetch(c + j + pf, 0, 0);
+			__builtin_prefetch(a + j + pf, 1, 0);
+		}
+		ldp(b + j, x0, x1);
+		ldp(b + j + 2*QELEMS, x2, x3);
+		ldp(c + j, y0, y1);
+		ldp(c + j + 2*QELEMS, y2, y3);
+		stp(a + j, N::fma(x0, y0, scalar), N::fma(x1, y1, scalar));
+		stp(a + j + 2*QELEMS, N::fma(x2, y2, scalar), N::fma(x3, y3, scalar));
+	}
+	for (; j < n; j++)
+	    a[j] = b[j]+scalar*c[j];
+}
+
+const KernelSet kernel_set_neon = {
+	"neon", "AArch64 NEON ld1/st1 x4",
+	neon_available, neon_copy, neon_scale, neon_add, neon_triad
+};
+const KernelSet kernel_set_neon_ldp = {
+	"neon-ldp", "AArch64 NEON ldp/stp q-register pairs",
+	neon_available, ldp_copy, ldp_scale, ldp_add, ldp_triad
+};
+
+#if defined(__ARM_FEATURE_SVE)
+
+#ifndef HWCAP_SVE
+# define HWCAP_SVE	(1UL << 22)
+#endif
+
+template <typename T> struct Sve;
+template <> struct Sve<double> {
+	static svbool_t whilelt(int64_t i, int64_t n) { return svwhilelt_b64(i, n); }
+	static int64_t lanes() { return (int64_t)svcntd(); }
+};
+template <> struct Sve<float> {
+	static svbool_t whilelt(int64_t i, int64_t n) { return svwhilelt_b32(i, n); }
+	static int64_t lanes() { return (int64_t)svcntw(); }
+};
+
+typedef Sve<STREAM_TYPE> S;
+
+static bool sve_available() {
+	return (getauxval(AT_HWCAP) & HWCAP_SVE) != 0;
+}
+
+static void sve_copy(STREAM_TYPE *c, const STREAM_TYPE *a, ssize_t n) {
+	const ssize_t pf = prefetch_elems();
+	const int64_t vl = S::lanes();
+	for (int64_t j = 0; j < n; j += vl) {
+		svbool_t pg = S::whilelt(j, n);
+		if (pf) {
+			__builtin_prefetch(a + j + pf, 0, 0);
+			__builtin_prefetch(c + j + pf, 1, 0);
+		}
+		svst1(pg, c + j, svld1(pg, a + j));
+	}
+}
+
+static void sve_scale(STREAM_TYPE *b, const STREAM_TYPE *c, STREAM_TYPE scalar, ssize_t n) {
+	const ssize_t pf = prefetch_elems();
+	const int64_t vl = S::lanes();
+	for (int64_t j = 0; j < n; j += vl) {
+		svbool_t pg = S::whilelt(j, n);
+		if (pf) {
+			__builtin_prefetch(c + j + pf, 0, 0);
+			__builtin_prefetch(b + j + pf, 1, 0);
+		}
+		svst1(pg, b + j, svmul_x(pg, svld1(pg, c + j), scalar));
+	}
+}
+
+static void sve_add(STREAM_TYPE *c, const STREAM_TYPE *a, const STREAM_TYPE *b, ssize_t n) {
+	const ssize_t pf = prefetch_elems();
+	const int64_t vl = S::lanes();
+	for (int64_t j = 0; j < n; j += vl) {
+		svbool_t pg = S::whilelt(j, n);
+		if (pf) {
+			__builtin_prefetch(a + j + pf, 0, 0);
+			__builtin_prefetch(b + j + pf, 0, 0);
+			__builtin_prefetch(c + j + pf, 1, 0);
+		}
+		svst1(pg, c + j, svadd_x(pg, svld1(pg, a + j), svld1(pg, b + j)));
+	}
+}
+
+static void sve_triad(STREAM_TYPE *a, const STREAM_TYPE *b, const STREAM_TYPE *c,
+                      STREAM_TYPE scalar, ssize_t n) {
+	const ssize_t pf = prefetch_elems();
+	const int64_t vl = S::lanes();
+	for (int64_t j = 0; j < n; j += vl) {
+		svbool_t pg = S::whilelt(j, n);
+		if (pf) {
+			__builtin_prefetch(b + j + pf, 0, 0);
+			__builtin_prefetch(c + j + pf, 0, 0);
+			__builtin_prefetch(a + j + pf, 1, 0);
+		}
+		/* b + c*scalar */
+		svst1(pg, a + j, svmla_x(pg, svld1(pg, b + j), svld1(pg, c + j), scalar));
+	}
+}
+
+const KernelSet kernel_set_sve = {
+	"sve", "AArch64 SVE, vector-length agnostic",
+	sve_available, sve_copy, sve_scale, sve_add, sve_triad
+};
+
+#else /* !__ARM_FEATURE_SVE */
+
+static bool sve_unavailable() {
+	return false;
+}
+
+const KernelSet kernel_set_sve = {
+	"sve", "AArch64 SVE (needs an SVE-enabled build, e.g. -march=armv8.2-a+sve)",
+	sve_unavailable, NULL, NULL, NULL, NULL
+};
+
+#endif /* __ARM_FEATURE_SVE */
+
+#else /* !__aarch64__ */
+
+static bool aarch64_unavailable() {
+	return false;
+}
+
+const KernelSet kernel_set_neon = {
+	"neon", "AArch64 NEON ld1/st1 x4 (AARCH64 build only)",
+	aarch64_unavailable, NULL, NULL, NULL, NULL
+};
+const KernelSet kernel_set_neon_ldp = {
+	"neon-ldp", "AArch64 NEON ldp/stp q-register pairs (AARCH64 build only)",
+	aarch64_unavailable, NULL, NULL, NULL, NULL
+};
+const KernelSet kernel_set_sve = {
+	"sve", "AArch64 SVE (AARCH64 build only)",
+	aarch64_unavailable, NULL, NULL, NULL, NULL
+};
+
+#endif /* __aarch64__ */
@@ -0,0 +1,198 @@
+/*-----------------------------------------------------------------------*/
+/* RISC-V Vector (RVV 1.0) STREAM kernels for the GEM5_RV64 target.      */
+/*                                                                       */
+/* All three variants are vector-length agnostic: every strip asks       */
+/* vsetvl for as many elements as the hardware takes, so the same binary */
+/* runs on any VLEN the simulated core is configured with.               */
+/*   rvv          unit-stride vle/vse                                    */
+/*   rvv-strided  vlse/vsse; the chunk is walked as 'stride' interleaved */
+/*                passes so every element is still touched exactly once  */
+/*   rvv-indexed  vluxei/vsuxei gathers and scatters over the strip      */
+/* Building them needs a V-enabled -march (e.g. rv64gcv); otherwise the  */
+/* variants are listed as unavailable.                                   */
+/*-----------------------------------------------------------------------*/
+# include "stream_kernels.h"
+
+#if defined(__riscv_vector)
+# include <stddef.h>
+# include <sys/auxv.h>
+# include <riscv_vector.h>
+
+template <typename T> struct Rvv;
+
+template <> struct Rvv<double> {
+	typedef vfloat64m8_t vec;
+	typedef vuint64m8_t  idx;
+	static size_t setvl(size_t n) { return __riscv_vsetvl_e64m8(n); }
+	static vec load(const double *p, size_t vl) { return __riscv_vle64_v_f64m8(p, vl); }
+	static void store(double *p, vec v, size_t vl) { __riscv_vse64_v_f64m8(p, v, vl); }
+	static vec load_strided(const double *p, ptrdiff_t s, size_t vl) { return __riscv_vlse64_v_f64m8(p, s, vl); }
+	static void store_strided(double *p, ptrdiff_t s, vec v, size_t vl) { __riscv_vsse64_v_f64m8(p, s, v, vl); }
+	static idx offsets(size_t vl) { return __riscv_vsll_vx_u64m8(__riscv_vid_v_u64m8(vl), 3, vl); }
+	static vec load_indexed(const double *p, idx o, size_t vl) { return __riscv_vluxei64_v_f64m8(p, o, vl); }
+	static void store_indexed(double *p, idx o, vec v, size_t vl) { __riscv_vsuxei64_v_f64m8(p, o, v, vl); }
+	static vec mul(vec v, double s, size_t vl) { return __riscv_vfmul_vf_f64m8(v, s, vl); }
+	static vec add(vec x, vec y, size_t vl) { return __riscv_vfadd_vv_f64m8(x, y, vl); }
+	/* acc + s*x */
+	static vec fma(vec acc, double s, vec x, size_t vl) { return __riscv_vfmacc_vf_f64m8(acc, s, x, vl); }
+};
+
+template <> struct Rvv<float> {
+	typedef vfloat32m8_t vec;
+	typedef vuint32m8_t  idx;
+	static size_t setvl(size_t n) { return __riscv_vsetvl_e32m8(n); }
+	static vec load(const float *p, size_t vl) { return __riscv_vle32_v_f32m8(p, vl); }
+	static void store(float *p, vec v, size_t vl) { __riscv_vse32_v_f32m8(p, v, vl); }
+	static vec load_strided(const float *p, ptrdiff_t s, size_t vl) { return __riscv_vlse32_v_f32m8(p, s, vl); }
+	static void store_strided(float *p, ptrdiff_t s, vec v, size_t vl) { __riscv_vsse32_v_f32m8(p, s, v, vl); }
+	static idx offsets(size_t vl) { return __riscv_vsll_vx_u32m8(__riscv_vid_v_u32m8(vl), 2, vl); }
+	static vec load_indexed(const float *p, idx o, size_t vl) { return __riscv_vluxei32_v_f32m8(p, o, vl); }
+	static void store_indexed(float *p, idx o, vec v, size_t vl) { __riscv_vsuxei32_v_f32m8(p, o, v, vl); }
+	static vec mul(vec v, float s, size_t vl) { return __riscv_vfmul_vf_f32m8(v, s, vl); }
+	static vec add(vec x, vec y, size_t vl) { return __riscv_vfadd_vv_f32m8(x, y, vl); }
+	static vec fma(vec acc, float s, vec x, size_t vl) { return __riscv_vfmacc_vf_f32m8(acc, s, x, vl); }
+};
+
+typedef Rvv<STREAM_TYPE> V;
+
+static bool rvv_available() {
+	/* gem5 SE mode may leave AT_HWCAP empty; trust the build then */
+	unsigned long hwcap = getauxval(AT_HWCAP);
+	return hwcap == 0 || (hwcap & (1UL << ('V' - 'A')));
+}
+
+/* --- rvv: unit stride --- */
+
+static void rvv_copy(STREAM_TYPE *c, const STREAM_TYPE *a, ssize_t n) {
+	for (size_t vl; n > 0; n -= vl, a += vl, c += vl) {
+		vl = V::setvl(n);
+		V::store(c, V::load(a, vl), vl);
+	}
+}
+
+static void rvv_scale(STREAM_TYPE *b, const STREAM_TYPE *c, STREAM_TYPE scalar, ssize_t n) {
+	for (size_t vl; n > 0; n -= vl, b += vl, c += vl) {
+		vl = V::setvl(n);
+		V::store(b, V::mul(V::load(c, vl), scalar, vl), vl);
+	}
+}
+
+static void rvv_add(STREAM_TYPE *c, const STREAM_TYPE *a, const STREAM_TYPE *b, ssize_t n) {
+	for (size_t vl; n > 0; n -= vl, a += vl, b += vl, c += vl) {
+		vl = V::setvl(n);
+		V::store(c, V::add(V::load(a, vl), V::load(b, vl), vl), vl);
+	}
+}
+
+static void rvv_triad(STREAM_TYPE *a, const STREAM_TYPE *b, const STREAM_TYPE *c,
+                      STREAM_TYPE scalar, ssize_t n) {
+	for (size_t vl; n > 0; n -= vl, a += vl, b += vl, c += vl) {
+		vl = V::setvl(n);
+		V::store(a, V::fma(V::load(b, vl), scalar, V::load(c, vl), vl), vl);
+	}
+}
+
+/* --- rvv-strided: 'stride' interleaved passes of vlse/vsse --- */
+
+# define STRIDED_PASSES(n, body)                                          \
+	ssize_t s = kernel_params.stride > 0 ? kernel_params.stride : 1;      \
+	ptrdiff_t sb = s * (ptrdiff_t)sizeof(STREAM_TYPE);                    \
+	for (ssize_t p = 0; p < s && p < (n); p++) {                          \
+		ssize_t cnt = ((n) - p + s - 1) / s;                              \
+		for (size_t vl, off = p; cnt > 0; cnt -= vl, off += vl * s) {     \
+			vl = V::setvl(cnt);                                           \
+			body;                                                         \
+		}                                                                 \
+	}
+
+static void rvvs_copy(STREAM_TYPE *c, const STREAM_TYPE *a, ssize_t n) {
+	STRIDED_PASSES(n,
+		V::store_strided(c + off, sb, V::load_strided(a + off, sb, vl), vl))
+}
+
+static void rvvs_scale(STREAM_TYPE *b, const STREAM_TYPE *c, STREAM_TYPE scalar, ssize_t n) {
+	STRIDED_PASSES(n,
+		V::store_strided(b + off, sb, V::mul(V::load_strided(c + off, sb, vl), scalar, vl), vl))
+}
+
+static void rvvs_add(STREAM_TYPE *c, const STREAM_TYPE *a, const STREAM_TYPE *b, ssize_t n) {
+	STRIDED_PASSES(n,
+		V::store_strided(c + off, sb, V::add(V::load_strided(a + off, sb, vl),
+		                                     V::load_strided(b + off, sb, vl), vl), vl))
+}
+
+static void rvvs_triad(STREAM_TYPE *a, const STREAM_TYPE *b, const STREAM_TYPE *c,
+                       STREAM_TYPE scalar, ssize_t n) {
+	STRIDED_PASSES(n,
+		V::store_strided(a + off, sb, V::fma(V::load_strided(b + off, sb, vl), scalar,
+		                                     V::load_strided(c + off, sb, vl), vl), vl))
+}
+
+/* --- rvv-indexed: gather/scatter with byte offsets 0, w, 2w, ... --- */
+
+static void rvvi_copy(STREAM_TYPE *c, const STREAM_TYPE *a, ssize_t n) {
+	for (size_t vl; n > 0; n -= vl, a += vl, c += vl) {
+		vl = V::setvl(n);
+		V::idx o = V::offsets(vl);
+		V::store_indexed(c, o, V::load_indexed(a, o, vl), vl);
+	}
+}
+
+static void rvvi_scale(STREAM_TYPE *b, const STREAM_TYPE *c, STREAM_TYPE scalar, ssize_t n) {
+	for (size_t vl; n > 0; n -= vl, b += vl, c += vl) {
+		vl = V::setvl(n);
+		V::idx o = V::offsets(vl);
+		V::store_indexed(b, o, V::mul(V::load_indexed(c, o, vl), scalar, vl), vl);
+	}
+}
+
+static void rvvi_add(STREAM_TYPE *c, const STREAM_TYPE *a, const STREAM_TYPE *b, ssize_t n) {
+	for (size_t vl; n > 0; n -= vl, a += vl, b += vl, c += vl) {
+		vl = V::setvl(n);
+		V::idx o = V::offsets(vl);
+		V::store_indexed(c, o, V::add(V::load_indexed(a, o, vl), V::load_indexed(b, o, vl), vl), vl);
+	}
+}
+
+static void rvvi_triad(STREAM_TYPE *a, const STREAM_TYPE *b, const STREAM_TYPE *c,
+                       STREAM_TYPE scalar, ssize_t n) {
+	for (size_t vl; n > 0; n -= vl, a += vl, b += vl, c += vl) {
+		vl = V::setvl(n);
+		V::idx o = V::offsets(vl);
+		V::store_indexed(a, o, V::fma(V::load_indexed(b, o, vl), scalar, V::load_indexed(c, o, vl), vl), vl);
+	}
+}
+
+const KernelSet kernel_set_rvv = {
+	"rvv", "RVV 1.0 unit-stride, vector-length agnostic",
+	rvv_available, rvv_copy, rvv_scale, rvv_add, rvv_triad
+};
+const KernelSet kernel_set_rvv_strided = {
+	"rvv-strided", "RVV 1.0 strided loads/stores (--stride elements)",
+	rvv_available, rvvs_copy, rvvs_scale, rvvs_add, rvvs_triad
+};
+const KernelSet kernel_set_rvv_indexed = {
+	"rvv-indexed", "RVV 1.0 indexed (gather/scatter) loads/stores",
+	rvv_available, rvvi_copy, rvvi_scale, rvvi_add, rvvi_triad
+};
+
+#else /* !__riscv_vector */
+
+static bool rvv_unavailable() {
+	return false;
+}
+
+const KernelSet kernel_set_rvv = {
+	"rvv", "RVV 1.0 unit-stride (needs a V-enabled RISC-V build)",
+	rvv_unavailable, NULL, NULL, NULL, NULL
+};
+const KernelSet kernel_set_rvv_strided = {
+	"rvv-strided", "RVV 1.0 strided loads/stores (needs a V-enabled RISC-V build)",
+	rvv_unavailable, NULL, NULL, NULL, NULL
+};
+const KernelSet kernel_set_rvv_indexed = {
+	"rvv-indexed", "RVV 1.0 indexed loads/stores (needs a V-enabled RISC-V build)",
+	rvv_unavailable, NULL, NULL, NULL, NULL
+};
+
+#endif /* __riscv_vector */
@@ -0,0 +1,298 @@
+/*-----------------------------------------------------------------------*/
+/* memcpy implementation shoot-out across copy sizes.                    */
+/*-----------------------------------------------------------------------*/
+# include <stdint.h>
+# include <stdlib.h>
+# include <string.h>
+# include "stream_memcpy.h"
+# include "stream_output.h"
+# include "stream_stats.h"
+# include "stream_timer.h"
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+#if defined(__x86_64__)
+# include <cpuid.h>
+# include <immintrin.h>
+#endif
+
+static const KernelSet *kernel_copy_set = NULL;
+
+static bool always() {
+	return true;
+}
+
+static void kernel_copy(void *dst, const void *src, size_t n) {
+	kernel_copy_set->copy((STREAM_TYPE *)dst, (const STREAM_TYPE *)src, n / sizeof(STREAM_TYPE));
+}
+
+static void libc_copy(void *dst, const void *src, size_t n) {
+	memcpy(dst, src, n);
+}
+
+/* Sizes are multiples of a cache line, so whole STREAM_TYPE chunks cover n */
+static void parallel_copy(void *dst, const void *src, size_t n) {
+	#pragma omp parallel
+	{
+		ssize_t lo, hi;
+		kernel_chunk(n / sizeof(STREAM_TYPE), &lo, &hi);
+		memcpy((char *)dst + lo * sizeof(STREAM_TYPE), (const char *)src + lo * sizeof(STREAM_TYPE),
+		       (hi - lo) * sizeof(STREAM_TYPE));
+	}
+}
+
+#if defined(__x86_64__)
+
+static void cpuid7(unsigned *ebx, unsigned *edx) {
+	unsigned a, c;
+	*ebx = *edx = 0;
+	if (__get_cpuid_max(0, NULL) >= 7)
+		__cpuid_count(7, 0, a, *ebx, c, *edx);
+}
+
+const char *memcpy_cpu_features() {
+	unsigned ebx, edx;
+	cpuid7(&ebx, &edx);
+	bool erms = ebx & (1u << 9), fsrm = edx & (1u << 4);
+	return erms && fsrm ? "ERMS FSRM" : erms ? "ERMS" : fsrm ? "FSRM" : "none";
+}
+
+static void movsb_copy(void *dst, const void *src, size_t n) {
+	__asm__ __volatile__("rep movsb" : "+D"(dst), "+S"(src), "+c"(n) : : "memory");
+}
+
+static bool avx2_available() {
+	return __builtin_cpu_supports("avx2");
+}
+
+__attribute__((target("avx2")))
+static void avx2_copy(void *dst, const void *src, size_t n) {
+	char *d = (char *)dst;
+	const char *s = (const char *)src;
+	size_t i = 0;
+	for (; i + 128 <= n; i += 128) {
+		__m256i v0 = _mm256_loadu_si256((const __m256i *)(s + i));
+		__m256i v1 = _mm256_loadu_si256((const __m256i *)(s + i + 32));
+		__m256i v2 = _mm256_loadu_si256((const __m256i *)(s + i + 64));
+		__m256i v3 = _mm256_loadu_si256((const __m256i *)(s + i + 96));
+		_mm256_storeu_si256((__m256i *)(d + i), v0);
+		_mm256_storeu_si256((__m256i *)(d + i + 32), v1);
+		_mm256_storeu_si256((__m256i *)(d + i + 64), v2);
+		_mm256_storeu_si256((__m256i *)(d + i + 96), v3);
+	}
+	for (; i + 32 <= n; i += 32)
+		_mm256_storeu_si256((__m256i *)(d + i), _mm256_loadu_si256((const __m256i *)(s + i)));
+	memcpy(d + i, s + i, n - i);
+}
+
+static bool avx512_available() {
+	return __builtin_cpu_supports("avx512f");
+}
+
+__attribute__((target("avx512f")))
+static void avx512_copy(void *dst, const void *src, size_t n) {
+	char *d = (char *)dst;
+	const char *s = (const char *)src;
+	size_t i = 0;
+	for (; i + 256 <= n; i += 256) {
+		__m512i v0 = _mm512_loadu_si512(s + i);
+		__m512i v1 = _mm512_loadu_si512(s + i + 64);
+		__m512i v2 = _mm512_loadu_si512(s + i + 128);
+		__m512i v3 = _mm512_loadu_si512(s + i + 192);
+		_mm512_storeu_si512(d + i, v0);
+		_mm512_storeu_si512(d + i + 64, v1);
+		_mm512_storeu_si512(d + i + 128, v2);
+		_mm512_storeu_si512(d + i + 192, v3);
+	}
+	for (; i + 64 <= n; i += 64)
+		_mm512_storeu_si512(d + i, _mm512_loadu_si512(s + i));
+	memcpy(d + i, s + i, n - i);
+}
+
+/* Streaming stores need a 16-byte aligned destination: copy up to it first */
+static void nt_copy(void *dst, const void *src, size_t n) {
+	char *d = (char *)dst;
+	const char *s = (const char *)src;
+	size_t head = (16 - ((uintptr_t)d & 15)) & 15, i;
+	if (head > n)
+		head = n;
+	memcpy(d, s, head);
+	for (i = head; i + 64 <= n; i += 64) {
+		__m128i v0 = _mm_loadu_si128((const __m128i *)(s + i));
+		__m128i v1 = _mm_loadu_si128((const __m128i *)(s + i + 16));
+		__m128i v2 = _mm_loadu_si128((const __m128i *)(s + i + 32));
+		__m128i v3 = _mm_loadu_si128((const __m128i *)(s + i + 48));
+		_mm_stream_si128((__m128i *)(d + i), v0);
+		_mm_stream_si128((__m128i *)(d + i + 16), v1);
+		_mm_stream_si128((__m128i *)(d + i + 32), v2);
+		_mm_stream_si128((__m128i *)(d + i + 48), v3);
+	}
+	_mm_sfence();
+	memcpy(d + i, s + i, n - i);
+}
+
+# define X86_COPY(f)	always, f
+# define AVX2_COPY(f)	avx2_available, f
+# define AVX512_COPY(f)	avx512_available, f
+
+#else /* !__x86_64__ */
+
+const char *memcpy_cpu_features() {
+	return "none";
+}
+
+static bool x86_unavailable() {
+	return false;
+}
+
+# define X86_COPY(f)	x86_unavailable, NULL
+# define AVX2_COPY(f)	x86_unavailable, NULL
+# define AVX512_COPY(f)	x86_unavailable, NULL
+
+#endif /* __x86_64__ */
+
+static const MemcpyImpl impls[] = {
+	{ "kernel",    "Copy kernel of the selected variant", always, kernel_copy },
+	{ "memcpy",    "C library memcpy", always, libc_copy },
+	{ "rep-movsb", "x86-64 rep movsb", X86_COPY(movsb_copy) },
+	{ "avx2",      "AVX2 32-byte loads/stores", AVX2_COPY(avx2_copy) },
+	{ "avx512",    "AVX-512 64-byte loads/stores", AVX512_COPY(avx512_copy) },
+	{ "nt",        "SSE2 non-temporal stores", X86_COPY(nt_copy) },
+	{ "parallel",  "memcpy per OpenMP thread", always, parallel_copy },
+};
+
+# define N_IMPLS	(sizeof(impls) / sizeof(impls[0]))
+
+size_t memcpy_impl_count() {
+	return N_IMPLS;
+}
+
+const MemcpyImpl *memcpy_impl(size_t i) {
+	return &impls[i];
+}
+
+int memcpy_run(const KernelSet *ks, size_t max_bytes, int ntimes, std::vector<MemcpyResult> *results) {
+	void *src, *dst;
+	if (posix_memalign(&src, 4096, max_bytes) != 0)
+		return -1;
+	if (posix_memalign(&dst, 4096, max_bytes) != 0) {
+		free(src);
+		return -1;
+	}
+	/* Fault everything in before the first sample */
+	memset(src, 1, max_bytes);
+	memset(dst, 0, max_bytes);
+	kernel_copy_set = ks;
+
+	std::vector<double> rate(ntimes);
+	results->clear();
+	for (size_t bytes = MEMCPY_MIN_BYTES; bytes <= max_bytes; bytes *= 2) {
+		MemcpyResult r;
+		r.bytes = bytes;
+		r.best = 0;
+		long reps = bytes >= MEMCPY_SAMPLE_BYTES ? 1 : MEMCPY_SAMPLE_BYTES / bytes;
+		for (size_t i = 0; i < N_IMPLS; i++) {
+			if (!impls[i].available()) {
+				r.GBps.push_back(0.0);
+				continue;
+			}
+			memset(dst, 0, bytes);
+			for (int k = 0; k < ntimes; k++) {
+				double t = timer_now();
+				for (long j = 0; j < reps; j++)
+					impls[i].copy(dst, src, bytes);
+				t = timer_now() - t;
+				rate[k] = 1.0E-09 * bytes * reps / t;
+			}
+			r.GBps.push_back(stats_median(&rate[1], ntimes - 1));
+			if (r.GBps[i] > r.GBps[r.best])
+				r.best = i;
+			if (memcmp(dst, src, bytes) != 0) {
+				fprintf(stderr, "%s copied %zu bytes wrong\n", impls[i].name, bytes);
+				free(src);
+				free(dst);
+				return -1;
+			}
+		}
+		results->push_back(r);
+	}
+	free(src);
+	free(dst);
+	return 0;
+}
+
+static void print_size(FILE *fp, const char *fmt, size_t bytes) {
+	char buf[32];
+	if (bytes >= (1UL << 30))
+		snprintf(buf, sizeof(buf), "%zu GiB", bytes >> 30);
+	else if (bytes >= (1UL << 20))
+		snprintf(buf, sizeof(buf), "%zu MiB", bytes >> 20);
+	else if (bytes >= (1UL << 10))
+		snprintf(buf, sizeof(buf), "%zu KiB", bytes >> 10);
+	else
+		snprintf(buf, sizeof(buf), "%zu B", bytes);
+	fprintf(fp, fmt, buf);
+}
+
+void memcpy_print(FILE *fp, const std::vector<MemcpyResult> &results) {
+	fprintf(fp, "memcpy shoot-out, GB/s copied (median), CPU string-copy features: %s\n",
+		memcpy_cpu_features());
+	fprintf(fp, "Size     ");
+	for (size_t i = 0; i < N_IMPLS; i++)
+		fprintf(fp, " %10s", impls[i].name);
+	fprintf(fp, "  Best\n");
+	for (size_t s = 0; s < results.size(); s++) {
+		const MemcpyResult &r = results[s];
+		print_size(fp, "%-9s", r.bytes);
+		for (size_t i = 0; i < N_IMPLS; i++)
+			if (impls[i].available())
+				fprintf(fp, " %10.2f", r.GBps[i]);
+			else
+				fprintf(fp, " %10s", "-");
+		fprintf(fp, "  %s\n", impls[r.best].name);
+	}
+	fprintf(fp, "Crossovers:");
+	for (size_t s = 0; s < results.size(); s++)
+		if (s == 0 || results[s].best != results[s-1].best) {
+			fprintf(fp, "%s %s from ", s == 0 ? "" : ",", impls[results[s].best].name);
+			print_size(fp, "%s", results[s].bytes);
+		}
+	fprintf(fp, "\n");
+}
+
+int memcpy_write_json(const char *path, const std::vector<MemcpyResult> &results) {
+	FILE *fp = result_open(path);
+	if (fp == NULL)
+		return -1;
+	fprintf(fp, "{\n  \"cpu_features\": \"%s\",\n  \"implementations\": [", memcpy_cpu_features());
+	for (size_t i = 0; i < N_IMPLS; i++)
+		fprintf(fp, "%s\"%s\"", i ? ", " : "", impls[i].name);
+	fprintf(fp, "],\n  \"results\": [\n");
+	for (size_t s = 0; s < results.size(); s++) {
+		const MemcpyResult &r = results[s];
+		fprintf(fp, "    {\"bytes\": %zu, \"best\": \"%s\", \"GBps\": {", r.bytes, impls[r.best].name);
+		bool first = true;
+		for (size_t i = 0; i < N_IMPLS; i++) {
+			if (!impls[i].available())
+				continue;
+			fprintf(fp, "%s\"%s\": %.4f", first ? "" : ", ", impls[i].name, r.GBps[i]);
+			first = false;
+		}
+		fprintf(fp, "}}%s\n", s + 1 < results.size() ? "," : "");
+	}
+	fprintf(fp, "  ]\n}\n");
+	return result_close(fp);
+}
+
+int memcpy_write_csv(const char *path, const std::vector<MemcpyResult> &results) {
+	FILE *fp = result_open(path);
+	if (fp == NULL)
+		return -1;
+	fprintf(fp, "bytes,implementation,GBps,best\n");
+	for (size_t s = 0; s < results.size(); s++)
+		for (size_t i = 0; i < N_IMPLS; i++)
+			if (impls[i].available())
+				fprintf(fp, "%zu,%s,%.4f,%d\n", results[s].bytes, impls[i].name,
+					results[s].GBps[i], (int)i == results[s].best);
+	return result_close(fp);
+}
@@ -0,0 +1,73 @@
+/*-----------------------------------------------------------------------*/
+/* memcpy implementation shoot-out across copy sizes.                    */
+/*                                                                       */
+/*   kernel     the Copy kernel of the selected variant (--kernels)      */
+/*   memcpy     the C library's                                          */
+/*   rep-movsb  x86-64 string copy; fast with ERMS, and for short        */
+/*              copies with FSRM (both reported from CPUID)              */
+/*   avx2       32-byte unaligned vector loads and stores                */
+/*   avx512     64-byte unaligned vector loads and stores                */
+/*   nt         16-byte non-temporal stores (SSE2), fenced at the end    */
+/*   parallel   memcpy of one 64-byte aligned chunk per OpenMP thread    */
+/* Every size from MEMCPY_MIN_BYTES doubling up to the maximum runs each */
+/* implementation on the same pair of buffers; small copies are repeated */
+/* back to back so every timed sample moves about MEMCPY_SAMPLE_BYTES.   */
+/* GB/s counts bytes copied, half the memory traffic STREAM's Copy       */
+/* reports. Implementations this CPU or build lacks are skipped.         */
+/*-----------------------------------------------------------------------*/
+#ifndef STREAM_MEMCPY_H
+#define STREAM_MEMCPY_H
+
+# include <stdio.h>
+# include <stddef.h>
+# include <vector>
+# include "stream_kernels.h"
+
+#ifndef MEMCPY_MIN_BYTES
+#   define MEMCPY_MIN_BYTES	64
+#endif
+
+/* Default largest size, in MiB */
+#ifndef MEMCPY_MAX_MIB
+#   define MEMCPY_MAX_MIB	1024
+#endif
+
+/* Bytes copied per timed sample, at least one copy */
+#ifndef MEMCPY_SAMPLE_BYTES
+#   define MEMCPY_SAMPLE_BYTES	(64 << 20)
+#endif
+
+struct MemcpyImpl {
+	const char	*name;
+	const char	*description;
+	bool		(*available)();
+	void		(*copy)(void *dst, const void *src, size_t n);
+};
+
+struct MemcpyResult {
+	size_t		bytes;		/* per copy */
+	std::vector<double> GBps;	/* per implementation, median; 0 if skipped */
+	int		best;		/* index of the fastest */
+};
+
+size_t memcpy_impl_count();
+const MemcpyImpl *memcpy_impl(size_t i);
+
+/* "ERMS FSRM", "ERMS", ... of this CPU, or "none" */
+const char *memcpy_cpu_features();
+
+/*
+ * Every available implementation at every size up to max_bytes; ntimes
+ * samples each, the first one untimed. 'ks' provides the kernel copy.
+ * Returns 0 on success.
+ */
+int memcpy_run(const KernelSet *ks, size_t max_bytes, int ntimes, std::vector<MemcpyResult> *results);
+
+/* Table and the sizes at which the fastest implementation changes */
+void memcpy_print(FILE *fp, const std::vector<MemcpyResult> &results);
+
+/* Write to 'path' ("-" for stdout); 0 on success */
+int memcpy_write_json(const char *path, const std::vector<MemcpyResult> &results);
+int memcpy_write_csv(const char *path, const std::vector<MemcpyResult> &results);
+
+#endif /* STREAM_MEMCPY_H */
@@ -0,0 +1,357 @@
+/*-----------------------------------------------------------------------*/
+/* Structured (JSON / CSV) result output for STREAM.                     */
+/*-----------------------------------------------------------------------*/
+# include <stdio.h>
+# include <string.h>
+# include <math.h>
+# include <time.h>
+# include <unistd.h>
+# include "stream_output.h"
+# include "stream_timer.h"
+
+void result_describe_host(RunConfig *cfg) {
+	char host[256];
+	if (gethostname(host, sizeof(host)) != 0)
+		strcpy(host, "unknown");
+	host[sizeof(host)-1] = '\0';
+	cfg->hostname = host;
+
+	char stamp[32];
+	time_t now = time(NULL);
+	struct tm tm;
+	gmtime_r(&now, &tm);
+	strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", &tm);
+	cfg->timestamp = stamp;
+
+	#if defined(GEM5_RV64)
+	cfg->build_target = "GEM5_RV64";
+	#elif defined(__aarch64__)
+	cfg->build_target = "AARCH64";
+	#elif defined(__amd64__)
+	cfg->build_target = "AMD64";
+	#else
+	cfg->build_target = "unknown";
+	#endif
+	cfg->page_size = sysconf(_SC_PAGESIZE);
+	cfg->timer = timer_info.name;
+	cfg->timer_hz = timer_info.hz;
+	cfg->timer_resolution_s = timer_info.resolution_s;
+	cfg->timer_overhead_s = timer_info.overhead_s;
+}
+
+void result_summarize(RunResult *res) {
+	for (size_t i = 0; i < res->kernels.size(); i++) {
+		KernelResult &k = res->kernels[i];
+		if (k.times.size() > 1)
+			k.stats = stats_summarize(&k.times[1], k.times.size() - 1);
+		else
+			k.stats = stats_summarize(NULL, 0);
+	}
+}
+
+/* --- JSON --- */
+
+static void json_string(FILE *fp, const std::string &s) {
+	fputc('"', fp);
+	for (size_t i = 0; i < s.size(); i++) {
+		unsigned char ch = s[i];
+		if (ch == '"' || ch == '\\')
+			fprintf(fp, "\\%c", ch);
+		else if (ch < 0x20)
+			fprintf(fp, "\\u%04x", ch);
+		else
+			fputc(ch, fp);
+	}
+	fputc('"', fp);
+}
+
+/* JSON has no NaN/Inf */
+static void json_number(FILE *fp, double v) {
+	if (isfinite(v))
+		fprintf(fp, "%.9g", v);
+	else
+		fputs("null", fp);
+}
+
+/* A RoiMetrics as a JSON object; 'indent' prefixes the member lines */
+static void json_roi(FILE *fp, const char *indent, const RoiMetrics &r) {
+	fprintf(fp, "{\n");
+	fprintf(fp, "%s  \"tsc\": %llu,\n",        indent, (unsigned long long)r.tsc);
+	fprintf(fp, "%s  \"instret\": %llu,\n",    indent, (unsigned long long)r.instret);
+	fprintf(fp, "%s  \"cpu_cycles\": %llu,\n", indent, (unsigned long long)r.cpu_cycles);
+	fprintf(fp, "%s  \"l1d_miss\": %llu,\n",   indent, (unsigned long long)r.l1d_miss);
+	fprintf(fp, "%s  \"l1d_hits\": %llu,\n",   indent, (unsigned long long)r.l1d_hits);
+	fprintf(fp, "%s  \"l2_miss\": %llu,\n",    indent, (unsigned long long)r.l2_miss);
+	fprintf(fp, "%s  \"l2_hits\": %llu,\n",    indent, (unsigned long long)r.l2_hits);
+	fprintf(fp, "%s  \"l3_miss\": %llu,\n",    indent, (unsigned long long)r.l3_miss);
+	fprintf(fp, "%s  \"l3_hits\": %llu,\n",    indent, (unsigned long long)r.l3_hits);
+	fprintf(fp, "%s  \"pkg_energy_j\": ",       indent); json_number(fp, r.pkg_energy_j);  fprintf(fp, ",\n");
+	fprintf(fp, "%s  \"dram_energy_j\": ",      indent); json_number(fp, r.dram_energy_j); fprintf(fp, ",\n");
+	fprintf(fp, "%s  \"freq_ghz\": [",         indent);
+	for (int t = 0; t < r.freq.threads; t++) {
+		fprintf(fp, t ? ", " : "");
+		json_number(fp, freq_ghz(r.freq, t));
+	}
+	fprintf(fp, "],\n");
+	fprintf(fp, "%s  \"elapsed_s\": ",          indent); json_number(fp, r.elapsed_s);
+	fprintf(fp, "\n%s}", indent);
+}
+
+static double mbps(double bytes, double seconds) {
+	return seconds > 0.0 ? 1.0E-06 * bytes / seconds : NAN;
+}
+
+void write_config_json(FILE *fp, const RunConfig &c) {
+	fprintf(fp, "  \"config\": {\n");
+	fprintf(fp, "    \"hostname\": ");       json_string(fp, c.hostname);       fprintf(fp, ",\n");
+	fprintf(fp, "    \"timestamp\": ");      json_string(fp, c.timestamp);      fprintf(fp, ",\n");
+	fprintf(fp, "    \"build_target\": ");   json_string(fp, c.build_target);   fprintf(fp, ",\n");
+	fprintf(fp, "    \"kernel_variant\": "); json_string(fp, c.kernel_variant); fprintf(fp, ",\n");
+	fprintf(fp, "    \"extra_kernels\": [");
+	for (size_t i = 0; i < c.extra_kernels.size(); i++) {
+		fprintf(fp, "%s", i ? ", " : "");
+		json_string(fp, c.extra_kernels[i]);
+	}
+	fprintf(fp, "],\n");
+	fprintf(fp, "    \"stride\": %ld,\n", c.stride);
+	fprintf(fp, "    \"prefetch_lines\": %ld,\n", c.prefetch_lines);
+	fprintf(fp, "    \"placement\": ");      json_string(fp, c.placement);      fprintf(fp, ",\n");
+	fprintf(fp, "    \"setup_s\": ");        json_number(fp, c.setup_s);        fprintf(fp, ",\n");
+	fprintf(fp, "    \"setup_faults\": %llu,\n", (unsigned long long)c.setup_faults);
+	fprintf(fp, "    \"num_elements\": %llu,\n", (unsigned long long)c.num_elements);
+	fprintf(fp, "    \"bytes_per_word\": %d,\n", c.bytes_per_word);
+	fprintf(fp, "    \"ntimes\": %d,\n", c.ntimes);
+	fprintf(fp, "    \"threads\": %d,\n", c.threads);
+	fprintf(fp, "    \"lproc_id\": %d,\n", c.lproc_id);
+	fprintf(fp, "    \"page_size\": %ld,\n", c.page_size);
+	fprintf(fp, "    \"align\": %zu,\n", c.align);
+	fprintf(fp, "    \"offsets\": [%zu, %zu, %zu],\n", c.offsets[0], c.offsets[1], c.offsets[2]);
+	fprintf(fp, "    \"timer\": ");              json_string(fp, c.timer);              fprintf(fp, ",\n");
+	fprintf(fp, "    \"timer_hz\": ");           json_number(fp, c.timer_hz);           fprintf(fp, ",\n");
+	fprintf(fp, "    \"timer_resolution_s\": "); json_number(fp, c.timer_resolution_s); fprintf(fp, ",\n");
+	fprintf(fp, "    \"timer_overhead_s\": ");   json_number(fp, c.timer_overhead_s);   fprintf(fp, ",\n");
+	fprintf(fp, "    \"roi_mode\": ");           json_string(fp, c.roi_mode);           fprintf(fp, ",\n");
+	fprintf(fp, "    \"roi_iteration\": %d\n", c.roi_iteration);
+	fprintf(fp, "  }");
+}
+
+int write_result_json(FILE *fp, const RunResult &res) {
+	fprintf(fp, "{\n  \"schema\": \"%s\",\n", RESULT_SCHEMA);
+	write_config_json(fp, res.config);
+	fprintf(fp, ",\n");
+
+	fprintf(fp, "  \"kernels\": [\n");
+	for (size_t i = 0; i < res.kernels.size(); i++) {
+		const KernelResult &k = res.kernels[i];
+		const SampleStats &st = k.stats;
+		fprintf(fp, "    {\n      \"name\": ");
+		json_string(fp, k.name);
+		fprintf(fp, ",\n      \"bytes\": ");
+		json_number(fp, k.bytes);
+		fprintf(fp, ",\n      \"times_s\": [");
+		for (size_t t = 0; t < k.times.size(); t++) {
+			fprintf(fp, t ? ", " : "");
+			json_number(fp, k.times[t]);
+		}
+		fprintf(fp, "],\n      \"warmup_iterations\": 1,\n");
+		fprintf(fp, "      \"stats\": {\n");
+		fprintf(fp, "        \"n\": %zu,\n", st.n);
+		fprintf(fp, "        \"min_s\": ");      json_number(fp, st.min);      fprintf(fp, ",\n");
+		fprintf(fp, "        \"mean_s\": ");     json_number(fp, st.mean);     fprintf(fp, ",\n");
+		fprintf(fp, "        \"median_s\": ");   json_number(fp, st.median);   fprintf(fp, ",\n");
+		fprintf(fp, "        \"p90_s\": ");      json_number(fp, st.p90);      fprintf(fp, ",\n");
+		fprintf(fp, "        \"p99_s\": ");      json_number(fp, st.p99);      fprintf(fp, ",\n");
+		fprintf(fp, "        \"max_s\": ");      json_number(fp, st.max);      fprintf(fp, ",\n");
+		fprintf(fp, "        \"stddev_s\": ");   json_number(fp, st.stddev);   fprintf(fp, ",\n");
+		fprintf(fp, "        \"mad_s\": ");      json_number(fp, st.mad);      fprintf(fp, ",\n");
+		fprintf(fp, "        \"ci_level\": ");   json_number(fp, st.ci_level); fprintf(fp, ",\n");
+		fprintf(fp, "        \"ci_lo_s\": ");    json_number(fp, st.ci_lo);    fprintf(fp, ",\n");
+		fprintf(fp, "        \"ci_hi_s\": ");    json_number(fp, st.ci_hi);    fprintf(fp, ",\n");
+		fprintf(fp, "        \"best_MBps\": ");  json_number(fp, mbps(k.bytes, st.min));    fprintf(fp, ",\n");
+		fprintf(fp, "        \"median_MBps\": "); json_number(fp, mbps(k.bytes, st.median)); fprintf(fp, ",\n");
+		fprintf(fp, "        \"outlier_iterations\": [");
+		bool first = true;
+		for (size_t t = 0; t < st.outlier.size(); t++) {
+			if (!st.outlier[t])
+				continue;
+			fprintf(fp, "%s%zu", first ? "" : ", ", t + 1);
+			first = false;
+		}
+		fprintf(fp, "]\n      }");
+		if (k.roi_samples > 0) {
+			fprintf(fp, ",\n      \"roi_samples\": %u,\n      \"roi\": ", k.roi_samples);
+			json_roi(fp, "      ", k.roi);
+		}
+		fprintf(fp, "\n    }%s\n", i + 1 < res.kernels.size() ? "," : "");
+	}
+	fprintf(fp, "  ],\n");
+
+	fprintf(fp, "  \"roi\": ");
+	json_roi(fp, "  ", res.roi);
+	fprintf(fp, ",\n");
+
+	fprintf(fp, "  \"roi_dumps\": [");
+	for (size_t i = 0; i < res.roi_dumps.size(); i++) {
+		const RoiDump &d = res.roi_dumps[i];
+		fprintf(fp, "%s\n    {\"index\": %u, \"kernel\": ", i ? "," : "", d.index);
+		json_string(fp, d.kernel);
+		fprintf(fp, ", \"iteration\": %d}", d.iteration);
+	}
+	fprintf(fp, "%s],\n", res.roi_dumps.empty() ? "" : "\n  ");
+
+	fprintf(fp, "  \"validation\": {\n    \"passed\": %s,\n    \"errors\": %d\n  }\n}\n",
+		res.validation_errors == 0 ? "true" : "false", res.validation_errors);
+	return ferror(fp) ? -1 : 0;
+}
+
+/* --- CSV --- */
+
+# define CSV_ROI_COLUMNS(p) \
+	p "tsc," p "instret," p "cpu_cycles," p "l1d_miss," p "l1d_hits," \
+	p "l2_miss," p "l2_hits," p "l3_miss," p "l3_hits," \
+	p "pkg_energy_j," p "dram_energy_j," \
+	p "freq_ghz_mean," p "freq_ghz_min," p "freq_ghz_max," p "elapsed_s,"
+
+static void csv_roi(FILE *fp, const RoiMetrics &r) {
+	double fmean, fmin, fmax;
+	freq_summary(r.freq, &fmean, &fmin, &fmax);
+	fprintf(fp, "%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%.6f,%.6f,%.4f,%.4f,%.4f,%.9g,",
+		(unsigned long long)r.tsc, (unsigned long long)r.instret,
+		(unsigned long long)r.cpu_cycles,
+		(unsigned long long)r.l1d_miss, (unsigned long long)r.l1d_hits,
+		(unsigned long long)r.l2_miss, (unsigned long long)r.l2_hits,
+		(unsigned long long)r.l3_miss, (unsigned long long)r.l3_hits,
+		r.pkg_energy_j, r.dram_energy_j, fmean, fmin, fmax, r.elapsed_s);
+}
+
+/*
+ * One row per kernel per iteration. Configuration, summary statistics,
+ * ROI counters and validation are repeated on every row so the file
+ * can be bulk-loaded into a flat table without joins.
+ */
+static void csv_header(FILE *fp) {
+	fprintf(fp, "schema,hostname,timestamp,build_target,kernel_variant,stride,prefetch_lines,placement,"
+		"setup_s,setup_faults,num_elements,bytes_per_word,ntimes,threads,lproc_id,page_size,align,offset_a,offset_b,offset_c,timer,timer_hz,"
+		"roi_mode,roi_iteration,"
+		"kernel,iteration,warmup,outlier,time_s,bandwidth_MBps,"
+		"min_s,median_s,p90_s,p99_s,max_s,ci_lo_s,ci_hi_s,best_MBps,median_MBps,"
+		CSV_ROI_COLUMNS("roi_") "kernel_roi_samples," CSV_ROI_COLUMNS("kernel_roi_")
+		"validation_passed\n");
+}
+
+static void csv_rows(FILE *fp, const RunResult &res) {
+	const RunConfig &c = res.config;
+
+	for (size_t i = 0; i < res.kernels.size(); i++) {
+		const KernelResult &k = res.kernels[i];
+		const SampleStats &st = k.stats;
+		for (size_t t = 0; t < k.times.size(); t++) {
+			bool outlier = t > 0 && t - 1 < st.outlier.size() && st.outlier[t-1];
+			fprintf(fp, "%s,%s,%s,%s,%s,%ld,%ld,%s,%.9g,%llu,%llu,%d,%d,%d,%d,%ld,%zu,%zu,%zu,%zu,%s,%.0f,%s,%d,",
+				RESULT_SCHEMA, c.hostname.c_str(), c.timestamp.c_str(),
+				c.build_target.c_str(), c.kernel_variant.c_str(),
+				c.stride, c.prefetch_lines, c.placement.c_str(),
+				c.setup_s, (unsigned long long)c.setup_faults,
+				(unsigned long long)c.num_elements, c.bytes_per_word, c.ntimes,
+				c.threads, c.lproc_id, c.page_size, c.align, c.offsets[0], c.offsets[1], c.offsets[2],
+				c.timer.c_str(), c.timer_hz,
+				c.roi_mode.c_str(), c.roi_iteration);
+			fprintf(fp, "%s,%zu,%d,%d,%.9g,%.3f,",
+				k.name.c_str(), t, t == 0, outlier ? 1 : 0,
+				k.times[t], mbps(k.bytes, k.times[t]));
+			fprintf(fp, "%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.3f,%.3f,",
+				st.min, st.median, st.p90, st.p99, st.max, st.ci_lo, st.ci_hi,
+				mbps(k.bytes, st.min), mbps(k.bytes, st.median));
+			csv_roi(fp, res.roi);
+			fprintf(fp, "%u,", k.roi_samples);
+			csv_roi(fp, k.roi);
+			fprintf(fp, "%d\n", res.validation_errors == 0);
+		}
+	}
+}
+
+int write_result_csv(FILE *fp, const RunResult &res) {
+	csv_header(fp);
+	csv_rows(fp, res);
+	return ferror(fp) ? -1 : 0;
+}
+
+/* Sweeps: one table, the swept config column tells the runs apart */
+int write_series_csv(FILE *fp, const std::vector<RunResult> &runs) {
+	csv_header(fp);
+	for (size_t i = 0; i < runs.size(); i++)
+		csv_rows(fp, runs[i]);
+	return ferror(fp) ? -1 : 0;
+}
+
+/* Sweeps: a JSON array of complete results, one per run */
+int write_series_json(FILE *fp, const std::vector<RunResult> &runs) {
+	fprintf(fp, "[\n");
+	for (size_t i = 0; i < runs.size(); i++) {
+		if (i > 0)
+			fprintf(fp, ",\n");
+		write_result_json(fp, runs[i]);
+	}
+	fprintf(fp, "]\n");
+	return ferror(fp) ? -1 : 0;
+}
+
+/* Raw per-iteration samples only, for jitter charts */
+int write_samples_csv(FILE *fp, const RunResult &res) {
+	fprintf(fp, "kernel,iteration,time_s,bandwidth_MBps,warmup,outlier\n");
+	for (size_t i = 0; i < res.kernels.size(); i++) {
+		const KernelResult &k = res.kernels[i];
+		for (size_t t = 0; t < k.times.size(); t++) {
+			bool outlier = t > 0 && t - 1 < k.stats.outlier.size() && k.stats.outlier[t-1];
+			fprintf(fp, "%s,%zu,%.9f,%.3f,%d,%d\n", k.name.c_str(), t, k.times[t],
+				mbps(k.bytes, k.times[t]), t == 0, outlier ? 1 : 0);
+		}
+	}
+	return ferror(fp) ? -1 : 0;
+}
+
+/* The original stdout once result_claim_stdout() has moved the report */
+static FILE *structured_out = NULL;
+
+int result_claim_stdout() {
+	int fd;
+	fflush(stdout);
+	if ((fd = dup(STDOUT_FILENO)) < 0 || (structured_out = fdopen(fd, "w")) == NULL)
+		return -1;
+	return dup2(STDERR_FILENO, STDOUT_FILENO) < 0 ? -1 : 0;
+}
+
+FILE *result_open(const char *path) {
+	if (strcmp(path, "-") == 0)
+		return structured_out != NULL ? structured_out : stdout;
+	return fopen(path, "w");
+}
+
+int result_close(FILE *fp) {
+	int rc = fflush(fp) != 0 || ferror(fp) ? -1 : 0;
+	if (fp != stdout && fp != structured_out && fclose(fp) != 0)
+		rc = -1;
+	return rc;
+}
+
+int write_result_file(const char *path, const RunResult &res,
+                      int (*writer)(FILE *, const RunResult &)) {
+	FILE *fp = result_open(path);
+	if (fp == NULL)
+		return -1;
+	int rc = writer(fp, res);
+	if (result_close(fp) != 0)
+		rc = -1;
+	return rc;
+}
+
+int write_series_file(const char *path, const std::vector<RunResult> &runs,
+                      int (*writer)(FILE *, const std::vector<RunResult> &)) {
+	FILE *fp = result_open(path);
+	if (fp == NULL)
+		return -1;
+	int rc = writer(fp, runs);
+	if (result_close(fp) != 0)
+		rc = -1;
+	return rc;
+}
@@ -0,0 +1,109 @@
+/*-----------------------------------------------------------------------*/
+/* Structured (JSON / CSV) result output for STREAM.                     */
+/*                                                                       */
+/* A RunResult is assembled after the timed loop has finished, so none   */
+/* of the formatting or file I/O below runs inside a timed region.       */
+/*-----------------------------------------------------------------------*/
+#ifndef STREAM_OUTPUT_H
+#define STREAM_OUTPUT_H
+
+# include <stdio.h>
+# include <stdint.h>
+# include <string>
+# include <vector>
+# include "stream_stats.h"
+# include "roi_counter.h"
+
+/* Bumped whenever a field is renamed or its meaning changes */
+# define RESULT_SCHEMA	"band_stream/2"
+
+struct RunConfig {
+	std::string	hostname;
+	std::string	timestamp;	/* ISO 8601, UTC */
+	std::string	build_target;	/* AMD64, AARCH64, GEM5_RV64 */
+	std::string	kernel_variant;	/* ISA path the kernels ran on */
+	std::vector<std::string> extra_kernels;	/* registry kernels timed after the STREAM four */
+	long		stride;		/* elements, strided variants only */
+	long		prefetch_lines;	/* software prefetch distance, 0 = none */
+	std::string	placement;	/* how a, b, c were allocated */
+	double		setup_s;	/* allocating and faulting them in */
+	uint64_t	setup_faults;	/* page faults taken meanwhile */
+	uint64_t	num_elements;
+	int		bytes_per_word;
+	int		ntimes;
+	int		threads;
+	int32_t		lproc_id;	/* CPU the ROI thread is pinned to, -1 if unpinned */
+	long		page_size;
+	size_t		align;		/* array base alignment, 0 = the allocator's */
+	size_t		offsets[3];	/* bytes past it of a, b, c */
+	std::string	timer;		/* timer source, see stream_timer.h */
+	double		timer_hz;
+	double		timer_resolution_s;
+	double		timer_overhead_s;
+	std::string	roi_mode;	/* "loop" or "kernel" */
+	int		roi_iteration;	/* -1: every iteration */
+
+	RunConfig() : stride(0), prefetch_lines(0), setup_s(0.0), setup_faults(0), num_elements(0), bytes_per_word(0), ntimes(0), threads(0),
+		lproc_id(-1), page_size(0), align(0), timer_hz(0.0),
+		timer_resolution_s(0.0), timer_overhead_s(0.0), roi_iteration(-1) { offsets[0] = offsets[1] = offsets[2] = 0; }
+};
+
+struct KernelResult {
+	std::string	name;
+	double		bytes;		/* bytes moved by one iteration */
+	std::vector<double> times;	/* every iteration; times[0] is warm-up */
+	SampleStats	stats;		/* over times[1..] */
+	unsigned	roi_samples;	/* per-kernel ROI regions summed into roi */
+	RoiMetrics	roi;
+
+	KernelResult() : bytes(0.0), roi_samples(0) { roi_metrics_zero(&roi); }
+};
+
+struct RunResult {
+	RunConfig	config;
+	std::vector<KernelResult> kernels;
+	RoiMetrics	roi;
+	std::vector<RoiDump> roi_dumps;
+	int		validation_errors;
+
+	RunResult() : validation_errors(0) { roi_metrics_zero(&roi); }
+};
+
+/* Fill in the host/build fields of a RunConfig that do not depend on options */
+void result_describe_host(RunConfig *cfg);
+
+/* Compute kernels[i].stats from kernels[i].times */
+void result_summarize(RunResult *res);
+
+/* The "config" member of a result object, without a trailing comma or newline */
+void write_config_json(FILE *fp, const RunConfig &c);
+
+int write_result_json(FILE *fp, const RunResult &res);
+int write_result_csv(FILE *fp, const RunResult &res);
+int write_samples_csv(FILE *fp, const RunResult &res);
+
+/*
+ * "-" names the structured-output stream: stdout, which must then carry
+ * nothing else. result_claim_stdout() keeps it for result_open("-") and
+ * sends everything else printed to stdout (the text report) to stderr.
+ * 0 on success.
+ */
+int result_claim_stdout();
+
+/* 'path' for writing, "-" for the structured-output stream; NULL on failure */
+FILE *result_open(const char *path);
+
+/* Flush and close what result_open() returned; 0 if everything got written */
+int result_close(FILE *fp);
+
+/* Open 'path' ("-" for stdout), run 'writer' and close; 0 on success */
+int write_result_file(const char *path, const RunResult &res,
+                      int (*writer)(FILE *, const RunResult &));
+
+/* Sweep modes: every run of the sweep in one file */
+int write_series_json(FILE *fp, const std::vector<RunResult> &runs);
+int write_series_csv(FILE *fp, const std::vector<RunResult> &runs);
+int write_series_file(const char *path, const std::vector<RunResult> &runs,
+                      int (*writer)(FILE *, const std::vector<RunResult> &));
+
+#endif /* STREAM_OUTPUT_H */
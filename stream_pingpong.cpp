@@ -0,0 +1,242 @@
+/*-----------------------------------------------------------------------*/
+/* Core-to-core cache-line ping-pong latency matrix.                     */
+/*-----------------------------------------------------------------------*/
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
+# include <math.h>
+# include <pthread.h>
+# include <sched.h>
+# include <stdint.h>
+# include <stdlib.h>
+# include <string.h>
+# include <algorithm>
+# include "stream_pingpong.h"
+# include "stream_kernels.h"
+# include "stream_output.h"
+# include "stream_stats.h"
+# include "stream_threads.h"
+# include "stream_timer.h"
+
+static const char *op_names[] = { "store", "cas" };
+
+/* The line that changes hands, alone in its cache line */
+struct PingPongLine {
+	uint64_t	seq;
+	char		pad[CACHE_LINE_BYTES - sizeof(uint64_t)];
+};
+
+struct PingPongPair {
+	PingPongOp	op;
+	PingPongLine	*line;
+	StartLine	*start;		/* both sides running on their CPU */
+	double		samples_ns[PINGPONG_SAMPLES];	/* initiator only */
+};
+
+/* Hand the line over: advance it from 'from' to 'from' + 1 */
+static inline void handoff(PingPongOp op, PingPongLine *l, uint64_t from) {
+	if (op == PINGPONG_STORE) {
+		__atomic_store_n(&l->seq, from + 1, __ATOMIC_RELEASE);
+		return;
+	}
+	uint64_t expected = from;
+	while (!__atomic_compare_exchange_n(&l->seq, &expected, from + 1, false,
+	                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+		expected = from;
+}
+
+static inline void await(const PingPongLine *l, uint64_t seq) {
+	while (__atomic_load_n(&l->seq, __ATOMIC_ACQUIRE) != seq)
+		;
+}
+
+/* Even sequence numbers belong to the initiator, odd ones to the responder */
+static void *initiator_main(void *arg) {
+	PingPongPair *p = (PingPongPair *)arg;
+	uint64_t seq = 0;
+	startline_wait(p->start);
+	for (int s = -1; s < PINGPONG_SAMPLES; s++) {
+		uint64_t t0 = timer_ticks();
+		for (int r = 0; r < PINGPONG_ROUNDS; r++) {
+			handoff(p->op, p->line, seq);
+			await(p->line, seq + 2);
+			seq += 2;
+		}
+		uint64_t t1 = timer_ticks();
+		if (s >= 0)
+			p->samples_ns[s] = 1.0E+09 * timer_seconds(t1 - t0) / PINGPONG_ROUNDS;
+	}
+	return NULL;
+}
+
+static void *responder_main(void *arg) {
+	PingPongPair *p = (PingPongPair *)arg;
+	uint64_t seq = 1;
+	if (!startline_wait(p->start))
+		return NULL;
+	for (long r = 0; r < (long)(PINGPONG_SAMPLES + 1) * PINGPONG_ROUNDS; r++) {
+		await(p->line, seq);
+		handoff(p->op, p->line, seq);
+		seq += 2;
+	}
+	return NULL;
+}
+
+/* One pair; fills the initiator's samples */
+static int measure_pair(PingPongOp op, int from, int to, PingPongLine *line, PingPongPair *init) {
+	StartLine start;
+	PingPongPair resp;
+	pthread_t ti, tr;
+
+	line->seq = 0;
+	init->op = resp.op = op;
+	init->line = resp.line = line;
+	startline_init(&start);
+	init->start = resp.start = &start;
+	if (thread_start_pinned(&tr, to, responder_main, &resp) != 0) {
+		fprintf(stderr, "Cannot start ping-pong thread on CPU %d\n", to);
+		return -1;
+	}
+	if (thread_start_pinned(&ti, from, initiator_main, init) != 0) {
+		fprintf(stderr, "Cannot start ping-pong thread on CPU %d\n", from);
+		startline_abort(&start);
+		pthread_join(tr, NULL);
+		return -1;
+	}
+	pthread_join(ti, NULL);
+	pthread_join(tr, NULL);
+	return 0;
+}
+
+bool pingpong_parse_op(const char *name, PingPongOp *op) {
+	for (int i = 0; i < 2; i++)
+		if (strcmp(name, op_names[i]) == 0) {
+			*op = (PingPongOp)i;
+			return true;
+		}
+	return false;
+}
+
+const char *pingpong_op_name(PingPongOp op) {
+	return op_names[op];
+}
+
+void pingpong_default_cpus(std::vector<long> *cpus) {
+	cpu_set_t set;
+	cpus->clear();
+	if (sched_getaffinity(0, sizeof(set), &set) != 0)
+		return;
+	for (int c = 0; c < CPU_SETSIZE; c++)
+		if (CPU_ISSET(c, &set))
+			cpus->push_back(c);
+}
+
+int pingpong_run(PingPongOp op, const std::vector<long> &cpus, PingPongMatrix *m) {
+	const size_t n = cpus.size();
+	void *mem;
+	if (posix_memalign(&mem, CACHE_LINE_BYTES, sizeof(PingPongLine)) != 0)
+		return -1;
+	PingPongLine *line = (PingPongLine *)mem;
+
+	m->op = op;
+	m->cpus = cpus;
+	m->median_ns.assign(n * n, NAN);
+	m->min_ns.assign(n * n, NAN);
+	int rc = 0;
+	for (size_t i = 0; i < n && rc == 0; i++) {
+		for (size_t j = 0; j < n; j++) {
+			if (i == j)
+				continue;
+			PingPongPair init;
+			if (measure_pair(op, cpus[i], cpus[j], line, &init) != 0) {
+				rc = -1;
+				break;
+			}
+			m->median_ns[i * n + j] = stats_median(init.samples_ns, PINGPONG_SAMPLES);
+			m->min_ns[i * n + j] = *std::min_element(init.samples_ns, init.samples_ns + PINGPONG_SAMPLES);
+		}
+	}
+	free(line);
+	return rc;
+}
+
+void pingpong_print(FILE *fp, const PingPongMatrix &m) {
+	const size_t n = m.cpus.size();
+	fprintf(fp, "Core-to-core round trip, %s handoff, ns (median of %d x %d)\n",
+		pingpong_op_name(m.op), PINGPONG_SAMPLES, PINGPONG_ROUNDS);
+	fprintf(fp, "from\\to");
+	for (size_t j = 0; j < n; j++)
+		fprintf(fp, " %6ld", m.cpus[j]);
+	fprintf(fp, "\n");
+
+	size_t lo = 0, hi = 0;
+	bool any = false;
+	for (size_t i = 0; i < n; i++) {
+		fprintf(fp, "%7ld", m.cpus[i]);
+		for (size_t j = 0; j < n; j++) {
+			double v = m.median_ns[i * n + j];
+			if (isnan(v)) {
+				fprintf(fp, " %6s", "-");
+				continue;
+			}
+			fprintf(fp, " %6.1f", v);
+			if (!any || v < m.median_ns[lo])
+				lo = i * n + j;
+			if (!any || v > m.median_ns[hi])
+				hi = i * n + j;
+			any = true;
+		}
+		fprintf(fp, "\n");
+	}
+	if (any)
+		fprintf(fp, "Closest pair %ld -> %ld: %.1f ns, farthest pair %ld -> %ld: %.1f ns\n",
+			m.cpus[lo / n], m.cpus[lo % n], m.median_ns[lo],
+			m.cpus[hi / n], m.cpus[hi % n], m.median_ns[hi]);
+}
+
+static void json_matrix(FILE *fp, const char *key, const std::vector<double> &v, size_t n) {
+	fprintf(fp, "  \"%s\": [\n", key);
+	for (size_t i = 0; i < n; i++) {
+		fprintf(fp, "    [");
+		for (size_t j = 0; j < n; j++) {
+			double x = v[i * n + j];
+			if (isnan(x))
+				fprintf(fp, "%snull", j ? ", " : "");
+			else
+				fprintf(fp, "%s%.3f", j ? ", " : "", x);
+		}
+		fprintf(fp, "]%s\n", i + 1 < n ? "," : "");
+	}
+	fprintf(fp, "  ]");
+}
+
+int pingpong_write_json(const char *path, const PingPongMatrix &m) {
+	const size_t n = m.cpus.size();
+	FILE *fp = result_open(path);
+	if (fp == NULL)
+		return -1;
+	fprintf(fp, "{\n  \"op\": \"%s\",\n  \"rounds\": %d,\n  \"samples\": %d,\n  \"cpus\": [",
+		pingpong_op_name(m.op), PINGPONG_ROUNDS, PINGPONG_SAMPLES);
+	for (size_t i = 0; i < n; i++)
+		fprintf(fp, "%s%ld", i ? ", " : "", m.cpus[i]);
+	fprintf(fp, "],\n");
+	json_matrix(fp, "median_ns", m.median_ns, n);
+	fprintf(fp, ",\n");
+	json_matrix(fp, "min_ns", m.min_ns, n);
+	fprintf(fp, "\n}\n");
+	return result_close(fp);
+}
+
+int pingpong_write_csv(const char *path, const PingPongMatrix &m) {
+	const size_t n = m.cpus.size();
+	FILE *fp = result_open(path);
+	if (fp == NULL)
+		return -1;
+	fprintf(fp, "op,from_cpu,to_cpu,median_ns,min_ns\n");
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = 0; j < n; j++)
+			if (i != j)
+				fprintf(fp, "%s,%ld,%ld,%.3f,%.3f\n", pingpong_op_name(m.op),
+					m.cpus[i], m.cpus[j], m.median_ns[i * n + j], m.min_ns[i * n + j]);
+	return result_close(fp);
+}
@@ -0,0 +1,58 @@
+/*-----------------------------------------------------------------------*/
+/* Core-to-core cache-line ping-pong latency matrix.                     */
+/*                                                                       */
+/* For every pair of CPUs, two threads pinned one to each bounce the     */
+/* ownership of a single cache line: the initiator hands it over, the    */
+/* responder sees the handoff and hands it back. One round trip is two   */
+/* coherence transfers, so the matrix shows which CPUs share a core, an  */
+/* L3 slice, a CCX or a socket. Handoff by                               */
+/*   store   a release store of the next sequence number, then spinning  */
+/*           on acquire loads until the other side answers               */
+/*   cas     a compare-and-swap from the expected to the next number,    */
+/*           retried until it succeeds (a locked RMW on every attempt)   */
+/*-----------------------------------------------------------------------*/
+#ifndef STREAM_PINGPONG_H
+#define STREAM_PINGPONG_H
+
+# include <stdio.h>
+# include <vector>
+
+/* Round trips per timed sample */
+#ifndef PINGPONG_ROUNDS
+#   define PINGPONG_ROUNDS	1000
+#endif
+
+/* Timed samples per pair, after one untimed warm-up sample */
+#ifndef PINGPONG_SAMPLES
+#   define PINGPONG_SAMPLES	16
+#endif
+
+enum PingPongOp {
+	PINGPONG_STORE = 0,
+	PINGPONG_CAS
+};
+
+struct PingPongMatrix {
+	PingPongOp		op;
+	std::vector<long>	cpus;
+	/* cpus.size()^2, row-major by initiator; NaN on the diagonal */
+	std::vector<double>	median_ns;	/* round trip, median over samples */
+	std::vector<double>	min_ns;		/* round trip, best sample */
+};
+
+bool pingpong_parse_op(const char *name, PingPongOp *op);
+const char *pingpong_op_name(PingPongOp op);
+
+/* Every CPU in our affinity mask, ascending */
+void pingpong_default_cpus(std::vector<long> *cpus);
+
+/* Measure every ordered pair of distinct entries of 'cpus'; 0 on success */
+int pingpong_run(PingPongOp op, const std::vector<long> &cpus, PingPongMatrix *m);
+
+void pingpong_print(FILE *fp, const PingPongMatrix &m);
+
+/* Write to 'path' ("-" for stdout); 0 on success */
+int pingpong_write_json(const char *path, const PingPongMatrix &m);
+int pingpong_write_csv(const char *path, const PingPongMatrix &m);
+
+#endif /* STREAM_PINGPONG_H */
@@ -0,0 +1,51 @@
+/*-----------------------------------------------------------------------*/
+/* Registry of the kernels timed by the main loop.                       */
+/*-----------------------------------------------------------------------*/
+# include <string.h>
+# include <vector>
+# include "stream_registry.h"
+
+static std::vector<const StreamKernel *> &kernels() {
+	/* Built on first use, so registry_add() works from static initializers */
+	static std::vector<const StreamKernel *> list;
+	if (list.empty()) {
+		list.push_back(&stream_kernel_copy);
+		list.push_back(&stream_kernel_scale);
+		list.push_back(&stream_kernel_add);
+		list.push_back(&stream_kernel_triad);
+		list.push_back(&stream_kernel_rowdecode);
+		list.push_back(&stream_kernel_checksum);
+	}
+	return list;
+}
+
+bool registry_add(const StreamKernel *k) {
+	if (registry_find(k->name) != NULL)
+		return false;
+	kernels().push_back(k);
+	return true;
+}
+
+const StreamKernel *registry_find(const char *name) {
+	for (size_t i = 0; i < kernels().size(); i++)
+		if (strcmp(kernels()[i]->name, name) == 0)
+			return kernels()[i];
+	return NULL;
+}
+
+size_t registry_size() {
+	return kernels().size();
+}
+
+const StreamKernel *registry_at(size_t i) {
+	return kernels()[i];
+}
+
+void registry_list(FILE *fp) {
+	for (size_t i = 0; i < kernels().size(); i++) {
+		const StreamKernel *k = kernels()[i];
+		fprintf(fp, "    %-12s %-8s %2zu B read, %2zu B written per element  %s%s\n",
+			k->name, k->elem_type, k->bytes_read, k->bytes_written,
+			k->description, k->always ? " [always]" : "");
+	}
+}
@@ -0,0 +1,86 @@
+/*-----------------------------------------------------------------------*/
+/* Registry of the kernels timed by the main loop.                       */
+/*                                                                       */
+/* Every kernel is described once: its name, element type and the bytes  */
+/* it reads and writes per element, a body that processes one thread's   */
+/* [lo, hi) share of the elements, and an optional verification.         */
+/* band_measure() times the enabled kernels in registry order, so        */
+/* timing, statistics, ROI counters, sampling and JSON/CSV output apply  */
+/* to a new kernel without touching the loop.                            */
+/*                                                                       */
+/* Copy, Scale, Add and Triad come first and always run; they work on    */
+/* the shared arrays a, b, c and are validated together as one chain     */
+/* (Triad's verify). Any other kernel is opt-in and keeps its data in    */
+/* ctx->state from setup(), so the STREAM arrays still validate. It      */
+/* gets one element per sizeof(STREAM_TYPE) bytes of a STREAM array,     */
+/* i.e. the same footprint per input buffer.                             */
+/*-----------------------------------------------------------------------*/
+#ifndef STREAM_REGISTRY_H
+#define STREAM_REGISTRY_H
+
+# include <stdio.h>
+# include <sys/types.h>
+# include "stream_kernels.h"
+
+struct KernelContext {
+	const KernelSet	*ks;		/* ISA variant of the STREAM kernels */
+	STREAM_TYPE	*a;
+	STREAM_TYPE	*b;
+	STREAM_TYPE	*c;
+	ssize_t		n;		/* STREAM elements per array */
+	STREAM_TYPE	scalar;
+	ssize_t		elements;	/* this kernel's, see stream_kernel_elements() */
+	void		*state;		/* from setup(); NULL if none */
+};
+
+struct StreamKernel {
+	const char	*name;		/* as in --extra-kernels and the JSON/CSV output */
+	const char	*label;		/* report label */
+	const char	*description;
+	const char	*elem_type;
+	size_t		elem_bytes;
+	size_t		bytes_read;	/* per element */
+	size_t		bytes_written;	/* per element */
+	bool		always;		/* part of the STREAM chain */
+	/*
+	 * Allocate and fill ctx->state; 0 on success. Runs again before every
+	 * measurement with ctx->state already set, and then only refills it.
+	 * NULL: nothing to set up
+	 */
+	int		(*setup)(KernelContext *ctx);
+	/* One thread's share [lo, hi); called from inside the OpenMP team */
+	void		(*body)(const KernelContext &ctx, ssize_t lo, ssize_t hi);
+	/* Failed checks after ntimes runs of the body; NULL: not checked on its own */
+	int		(*verify)(const KernelContext &ctx, int ntimes);
+	/* Release ctx->state; NULL: nothing to release */
+	void		(*teardown)(KernelContext *ctx);
+};
+
+/* The four STREAM kernels (bandstream.cpp) */
+extern const StreamKernel stream_kernel_copy;
+extern const StreamKernel stream_kernel_scale;
+extern const StreamKernel stream_kernel_add;
+extern const StreamKernel stream_kernel_triad;
+
+/* Production-representative extras (stream_workloads.cpp) */
+extern const StreamKernel stream_kernel_rowdecode;
+extern const StreamKernel stream_kernel_checksum;
+
+/* Elements of kernel 'k' over STREAM arrays of n elements */
+static inline ssize_t stream_kernel_elements(const StreamKernel *k, ssize_t n) {
+	return (ssize_t)(n * sizeof(STREAM_TYPE) / k->elem_bytes);
+}
+
+/* Append a user kernel; names must be unique. Returns false if taken */
+bool registry_add(const StreamKernel *k);
+
+/* Look up by name; NULL if unknown */
+const StreamKernel *registry_find(const char *name);
+
+size_t registry_size();
+const StreamKernel *registry_at(size_t i);
+
+/* One line per kernel */
+void registry_list(FILE *fp);
+
+#endif /* STREAM_REGISTRY_H */
@@ -0,0 +1,321 @@
+/*-----------------------------------------------------------------------*/
+/* Inter-core producer/consumer streaming over a shared ring.            */
+/*-----------------------------------------------------------------------*/
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
+# include <pthread.h>
+# include <sched.h>
+# include <stdint.h>
+# include <stdlib.h>
+# include <string.h>
+# include <algorithm>
+# include "stream_ring.h"
+# include "stream_kernels.h"
+# include "stream_output.h"
+# include "stream_stats.h"
+# include "stream_threads.h"
+# include "stream_timer.h"
+
+# define MSG_WORDS	(CACHE_LINE_BYTES / sizeof(uint64_t))
+
+static const char *class_names[] = { "smt", "same-l3", "cross-l3", "cross-socket", "unknown" };
+
+/* Word 0 is the sequence number, the rest is derived from it */
+struct RingMsg {
+	uint64_t	w[MSG_WORDS];
+};
+
+/* Every index alone on its line; the slots follow, line aligned */
+struct RingIndex {
+	uint64_t	v;
+	char		pad[CACHE_LINE_BYTES - sizeof(uint64_t)];
+};
+
+struct Ring {
+	RingIndex	head;		/* written by the producer */
+	RingIndex	tail;		/* written by the consumer */
+	RingMsg		slots[RING_SLOTS];
+};
+
+struct RingThread {
+	Ring		*ring;
+	StartLine	*start;
+	int		ntimes;
+	double		*seconds;	/* producer: per repetition */
+	double		*latency_ns;	/* producer: per latency message */
+	long		errors;		/* consumer */
+};
+
+static inline uint64_t payload(uint64_t seq, size_t i) {
+	return seq * 0x9e3779b97f4a7c15ULL + i;
+}
+
+static void *producer_main(void *arg) {
+	RingThread *p = (RingThread *)arg;
+	Ring *r = p->ring;
+	uint64_t head = 0, tail_cache = 0;
+
+	startline_wait(p->start);
+	for (int k = 0; k < p->ntimes; k++) {
+		uint64_t t0 = timer_ticks();
+		for (long m = 0; m < RING_MESSAGES; m++) {
+			while (head - tail_cache == RING_SLOTS)
+				tail_cache = __atomic_load_n(&r->tail.v, __ATOMIC_ACQUIRE);
+			RingMsg *s = &r->slots[head & (RING_SLOTS - 1)];
+			s->w[0] = head;
+			for (size_t i = 1; i < MSG_WORDS; i++)
+				s->w[i] = payload(head, i);
+			__atomic_store_n(&r->head.v, ++head, __ATOMIC_RELEASE);
+		}
+		/* Done when the consumer has taken the last message */
+		while ((tail_cache = __atomic_load_n(&r->tail.v, __ATOMIC_ACQUIRE)) != head)
+			;
+		p->seconds[k] = timer_seconds(timer_ticks() - t0);
+	}
+
+	/* Latency: the ring is empty before every push */
+	for (long m = 0; m < RING_LATENCY_MESSAGES; m++) {
+		RingMsg *s = &r->slots[head & (RING_SLOTS - 1)];
+		uint64_t t0 = timer_ticks();
+		s->w[0] = head;
+		for (size_t i = 1; i < MSG_WORDS; i++)
+			s->w[i] = payload(head, i);
+		__atomic_store_n(&r->head.v, ++head, __ATOMIC_RELEASE);
+		while (__atomic_load_n(&r->tail.v, __ATOMIC_ACQUIRE) != head)
+			;
+		p->latency_ns[m] = 0.5E+09 * timer_seconds(timer_ticks() - t0);
+	}
+	return NULL;
+}
+
+static void *consumer_main(void *arg) {
+	RingThread *p = (RingThread *)arg;
+	Ring *r = p->ring;
+	const uint64_t total = (uint64_t)p->ntimes * RING_MESSAGES + RING_LATENCY_MESSAGES;
+	uint64_t tail = 0, head_cache = 0;
+	long errors = 0;
+
+	if (!startline_wait(p->start))
+		return NULL;
+	while (tail < total) {
+		while (tail == head_cache)
+			head_cache = __atomic_load_n(&r->head.v, __ATOMIC_ACQUIRE);
+		const RingMsg *s = &r->slots[tail & (RING_SLOTS - 1)];
+		bool ok = s->w[0] == tail;
+		for (size_t i = 1; i < MSG_WORDS; i++)
+			ok = ok && s->w[i] == payload(tail, i);
+		errors += !ok;
+		__atomic_store_n(&r->tail.v, ++tail, __ATOMIC_RELEASE);
+	}
+	p->errors = errors;
+	return NULL;
+}
+
+static int measure_pair(const RingPair &pair, int ntimes, Ring *ring, RingResult *res) {
+	std::vector<double> seconds(ntimes), latency(RING_LATENCY_MESSAGES), gbps(ntimes);
+	StartLine start;
+	RingThread prod, cons;
+	pthread_t tp, tc;
+
+	memset(ring, 0, sizeof(*ring));
+	prod.ring = cons.ring = ring;
+	startline_init(&start);
+	prod.start = cons.start = &start;
+	prod.ntimes = cons.ntimes = ntimes;
+	prod.seconds = &seconds[0];
+	prod.latency_ns = &latency[0];
+	cons.errors = 0;
+	if (thread_start_pinned(&tc, pair.consumer, consumer_main, &cons) != 0) {
+		fprintf(stderr, "Cannot start ring consumer on CPU %ld\n", pair.consumer);
+		return -1;
+	}
+	if (thread_start_pinned(&tp, pair.producer, producer_main, &prod) != 0) {
+		fprintf(stderr, "Cannot start ring producer on CPU %ld\n", pair.producer);
+		startline_abort(&start);
+		pthread_join(tc, NULL);
+		return -1;
+	}
+	pthread_join(tp, NULL);
+	pthread_join(tc, NULL);
+
+	for (int k = 0; k < ntimes; k++)
+		gbps[k] = 1.0E-09 * RING_MESSAGES * sizeof(RingMsg) / seconds[k];
+	res->pair = pair;
+	res->GBps = stats_median(&gbps[1], ntimes - 1);
+	res->max_GBps = *std::max_element(gbps.begin() + 1, gbps.end());
+	res->latency_ns = stats_median(&latency[0], RING_LATENCY_MESSAGES);
+	res->errors = cons.errors;
+	return 0;
+}
+
+const char *ring_class_name(RingPairClass cls) {
+	return class_names[cls];
+}
+
+bool ring_parse_pairs(const char *arg, std::vector<RingPair> *pairs) {
+	pairs->clear();
+	for (const char *p = arg; ; p++) {
+		char *end;
+		RingPair pr;
+		pr.producer = strtol(p, &end, 10);
+		if (end == p || pr.producer < 0 || *end != ':')
+			return false;
+		p = end + 1;
+		pr.consumer = strtol(p, &end, 10);
+		if (end == p || pr.consumer < 0)
+			return false;
+		pr.cls = ring_classify(pr.producer, pr.consumer);
+		pairs->push_back(pr);
+		p = end;
+		if (*p == '\0')
+			return true;
+		if (*p != ',')
+			return false;
+	}
+}
+
+static bool read_sys(long cpu, const char *rel, char *buf, size_t len) {
+	char path[128];
+	snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%ld/%s", cpu, rel);
+	FILE *fp = fopen(path, "r");
+	if (fp == NULL)
+		return false;
+	bool ok = fgets(buf, len, fp) != NULL;
+	fclose(fp);
+	return ok;
+}
+
+/* Membership in a sysfs CPU list such as "0-3,64-67" */
+static bool list_has(const char *list, long cpu) {
+	const char *p = list;
+	while (*p != '\0' && *p != '\n') {
+		char *end;
+		long lo = strtol(p, &end, 10), hi = lo;
+		if (end == p)
+			return false;
+		if (*end == '-')
+			hi = strtol(end + 1, &end, 10);
+		if (cpu >= lo && cpu <= hi)
+			return true;
+		p = *end == ',' ? end + 1 : end;
+	}
+	return false;
+}
+
+/* The CPUs sharing cpu's L3, or false if no cache directory says level 3 */
+static bool l3_shared_list(long cpu, char *buf, size_t len) {
+	for (int idx = 0; idx < 8; idx++) {
+		char rel[64], level[16];
+		snprintf(rel, sizeof(rel), "cache/index%d/level", idx);
+		if (!read_sys(cpu, rel, level, sizeof(level)))
+			return false;
+		if (atoi(level) != 3)
+			continue;
+		snprintf(rel, sizeof(rel), "cache/index%d/shared_cpu_list", idx);
+		return read_sys(cpu, rel, buf, len);
+	}
+	return false;
+}
+
+RingPairClass ring_classify(long a, long b) {
+	char buf[1024], pa[32], pb[32];
+	if (read_sys(a, "topology/thread_siblings_list", buf, sizeof(buf)) && list_has(buf, b))
+		return RING_SMT;
+	if (l3_shared_list(a, buf, sizeof(buf)) && list_has(buf, b))
+		return RING_SAME_L3;
+	if (!read_sys(a, "topology/physical_package_id", pa, sizeof(pa)) ||
+	    !read_sys(b, "topology/physical_package_id", pb, sizeof(pb)))
+		return RING_UNKNOWN;
+	return atol(pa) == atol(pb) ? RING_CROSS_L3 : RING_CROSS_SOCKET;
+}
+
+static bool closer(const RingPair &x, const RingPair &y) {
+	return x.cls < y.cls;
+}
+
+void ring_default_pairs(std::vector<RingPair> *pairs) {
+	cpu_set_t set;
+	long first = -1;
+	bool found[RING_UNKNOWN + 1] = { false };
+	pairs->clear();
+	if (sched_getaffinity(0, sizeof(set), &set) != 0)
+		return;
+	for (int c = 0; c < CPU_SETSIZE; c++) {
+		if (!CPU_ISSET(c, &set))
+			continue;
+		if (first < 0) {
+			first = c;
+			continue;
+		}
+		RingPair pr = { first, c, ring_classify(first, c) };
+		if (!found[pr.cls]) {
+			found[pr.cls] = true;
+			pairs->push_back(pr);
+		}
+	}
+	std::sort(pairs->begin(), pairs->end(), closer);
+}
+
+int ring_run(const std::vector<RingPair> &pairs, int ntimes, std::vector<RingResult> *results) {
+	void *mem;
+	if (posix_memalign(&mem, CACHE_LINE_BYTES, sizeof(Ring)) != 0)
+		return -1;
+	Ring *ring = (Ring *)mem;
+	int rc = 0;
+
+	results->clear();
+	for (size_t i = 0; i < pairs.size(); i++) {
+		RingResult res;
+		if (measure_pair(pairs[i], ntimes, ring, &res) != 0) {
+			rc = -1;
+			break;
+		}
+		results->push_back(res);
+	}
+	free(ring);
+	return rc;
+}
+
+void ring_print(FILE *fp, const std::vector<RingResult> &results) {
+	fprintf(fp, "SPSC ring: %d slots of %d bytes, %d messages per repetition\n",
+		RING_SLOTS, (int)sizeof(RingMsg), RING_MESSAGES);
+	fprintf(fp, "Producer  Consumer  Class          Median GB/s  Best GB/s  Latency ns  Errors\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		const RingResult &r = results[i];
+		fprintf(fp, "%8ld  %8ld  %-13s  %11.3f  %9.3f  %10.1f  %6ld\n",
+			r.pair.producer, r.pair.consumer, ring_class_name(r.pair.cls),
+			r.GBps, r.max_GBps, r.latency_ns, r.errors);
+	}
+}
+
+int ring_write_json(const char *path, const std::vector<RingResult> &results) {
+	FILE *fp = result_open(path);
+	if (fp == NULL)
+		return -1;
+	fprintf(fp, "{\n  \"slots\": %d,\n  \"message_bytes\": %d,\n  \"messages\": %d,\n  \"pairs\": [\n",
+		RING_SLOTS, (int)sizeof(RingMsg), RING_MESSAGES);
+	for (size_t i = 0; i < results.size(); i++) {
+		const RingResult &r = results[i];
+		fprintf(fp, "    {\"producer\": %ld, \"consumer\": %ld, \"class\": \"%s\", \"GBps\": %.4f,"
+			" \"max_GBps\": %.4f, \"latency_ns\": %.3f, \"errors\": %ld}%s\n",
+			r.pair.producer, r.pair.consumer, ring_class_name(r.pair.cls), r.GBps,
+			r.max_GBps, r.latency_ns, r.errors, i + 1 < results.size() ? "," : "");
+	}
+	fprintf(fp, "  ]\n}\n");
+	return result_close(fp);
+}
+
+int ring_write_csv(const char *path, const std::vector<RingResult> &results) {
+	FILE *fp = result_open(path);
+	if (fp == NULL)
+		return -1;
+	fprintf(fp, "producer,consumer,class,GBps,max_GBps,latency_ns,errors\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		const RingResult &r = results[i];
+		fprintf(fp, "%ld,%ld,%s,%.4f,%.4f,%.3f,%ld\n",
+			r.pair.producer, r.pair.consumer, ring_class_name(r.pair.cls),
+			r.GBps, r.max_GBps, r.latency_ns, r.errors);
+	}
+	return result_close(fp);
+}
@@ -0,0 +1,83 @@
+/*-----------------------------------------------------------------------*/
+/* Inter-core producer/consumer streaming over a shared ring.            */
+/*                                                                       */
+/* A producer thread writes cache-line sized messages into a lock-free   */
+/* single-producer/single-consumer ring; a consumer thread pinned to     */
+/* another CPU reads every message and checks its contents. Each side    */
+/* keeps a private copy of the other side's index and only re-reads the  */
+/* shared one when the ring looks full (or empty), so the indices cost   */
+/* one coherence miss per lap rather than one per message.               */
+/*   bandwidth  RING_MESSAGES back to back, timed until the ring drains  */
+/*   latency    one message at a time; half the time from the push until */
+/*              the producer sees the consumer's tail move past it       */
+/* Pairs are classified from sysfs topology relative to each other as   */
+/* SMT siblings, sharing an L3, on one socket across L3 domains (CCX),   */
+/* or on different sockets.                                              */
+/*-----------------------------------------------------------------------*/
+#ifndef STREAM_RING_H
+#define STREAM_RING_H
+
+# include <stdio.h>
+# include <vector>
+
+/* Ring capacity in messages (a power of two) */
+#ifndef RING_SLOTS
+#   define RING_SLOTS		256
+#endif
+
+/* Messages per timed bandwidth repetition */
+#ifndef RING_MESSAGES
+#   define RING_MESSAGES	(1 << 20)
+#endif
+
+/* Messages of the latency phase */
+#ifndef RING_LATENCY_MESSAGES
+#   define RING_LATENCY_MESSAGES	(1 << 14)
+#endif
+
+enum RingPairClass {
+	RING_SMT = 0,
+	RING_SAME_L3,
+	RING_CROSS_L3,
+	RING_CROSS_SOCKET,
+	RING_UNKNOWN
+};
+
+struct RingPair {
+	long		producer;	/* CPU */
+	long		consumer;	/* CPU */
+	RingPairClass	cls;
+};
+
+struct RingResult {
+	RingPair	pair;
+	double		GBps;		/* median over repetitions */
+	double		max_GBps;
+	double		latency_ns;	/* one-way, median message */
+	long		errors;		/* messages that failed verification */
+};
+
+const char *ring_class_name(RingPairClass cls);
+
+/* "P:C[,P:C...]"; false on a malformed list */
+bool ring_parse_pairs(const char *arg, std::vector<RingPair> *pairs);
+
+/* Topology class of two CPUs from /sys/devices/system/cpu */
+RingPairClass ring_classify(long a, long b);
+
+/*
+ * One pair per class that the CPUs in our affinity mask offer, all with
+ * the first of them as producer.
+ */
+void ring_default_pairs(std::vector<RingPair> *pairs);
+
+/* ntimes bandwidth repetitions per pair, the first one untimed; 0 on success */
+int ring_run(const std::vector<RingPair> &pairs, int ntimes, std::vector<RingResult> *results);
+
+void ring_print(FILE *fp, const std::vector<RingResult> &results);
+
+/* Write to 'path' ("-" for stdout); 0 on success */
+int ring_write_json(const char *path, const std::vector<RingResult> &results);
+int ring_write_csv(const char *path, const std::vector<RingResult> &results);
+
+#endif /* STREAM_RING_H */
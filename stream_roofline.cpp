@@ -0,0 +1,273 @@
+/*-----------------------------------------------------------------------*/
+/* Roofline mode: arithmetic-intensity sweep over the Triad stream.      */
+/*-----------------------------------------------------------------------*/
+# include <math.h>
+# include <string.h>
+# include "stream_roofline.h"
+# include "stream_output.h"
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
+/* Relative error tolerated by the spot check (FMA contraction may differ
+   between the vector body and the scalar tail) */
+#ifndef ROOFLINE_EPSILON
+#   define ROOFLINE_EPSILON	(sizeof(STREAM_TYPE) == 4 ? 1.e-4 : 1.e-10)
+#endif
+
+/* Elements re-computed one at a time by the spot check */
+# define ROOFLINE_CHECKS	1024
+
+/* Fraction of the peak from which a point counts as compute bound */
+#ifndef ROOFLINE_PLATEAU
+#   define ROOFLINE_PLATEAU	0.8
+#endif
+
+/* Widest vector of the target; GCC lowers it to pieces where needed */
+#if defined(__AVX512F__)
+#   define ROOFLINE_VEC_BYTES	64
+#elif defined(__AVX__)
+#   define ROOFLINE_VEC_BYTES	32
+#else
+#   define ROOFLINE_VEC_BYTES	16
+#endif
+
+/*
+ * Independent vector chains kept in flight per step: enough to cover
+ * FMA latency times issue width on current cores
+ */
+#ifndef ROOFLINE_ILP
+#   define ROOFLINE_ILP	12
+#endif
+
+typedef STREAM_TYPE roofline_vec __attribute__((vector_size(ROOFLINE_VEC_BYTES)));
+# define ROOFLINE_LANES	(ssize_t)(sizeof(roofline_vec) / sizeof(STREAM_TYPE))
+
+/* One element the plain way: the tail of a chunk, and the spot check */
+template <int DEP, int IND>
+static STREAM_TYPE roofline_element(const STREAM_TYPE *s, STREAM_TYPE b, STREAM_TYPE c) {
+	STREAM_TYPE t[IND];
+	for (int i = 0; i < IND; i++)
+		t[i] = b;
+	for (int d = 0; d < DEP; d++)
+		for (int i = 0; i < IND; i++)
+			t[i] = t[i]*s[i] + c;
+	STREAM_TYPE sum = t[0];
+	for (int i = 1; i < IND; i++)
+		sum += t[i];
+	return sum;
+}
+
+/*
+ * a[j] = sum over IND chains of DEP steps t = t*s_i + c[j], starting at
+ * t = b[j]. Each chain has its own |s_i| < 1 so the values stay bounded
+ * and no two chains can be merged; without -ffast-math the compiler may
+ * not reassociate a chain either. A tile of TILE vectors of elements is
+ * advanced together, so every step issues IND*TILE >= ROOFLINE_ILP
+ * independent vector FMAs and high-DEP points measure throughput, not
+ * the latency of one chain. The DEP loop stays rolled to keep the body
+ * in the instruction cache.
+ */
+template <int DEP, int IND>
+static void roofline_kernel(STREAM_TYPE *a, const STREAM_TYPE *b, const STREAM_TYPE *c, ssize_t n) {
+	enum { TILE = IND >= ROOFLINE_ILP ? 1 : (ROOFLINE_ILP + IND - 1) / IND };
+	STREAM_TYPE s[IND];
+	ssize_t j = 0;
+	for (int i = 0; i < IND; i++)
+		s[i] = (STREAM_TYPE)(0.5 + 0.25 * i / IND);
+	for (; j + TILE * ROOFLINE_LANES <= n; j += TILE * ROOFLINE_LANES) {
+		roofline_vec t[IND][TILE], cv[TILE];
+		#pragma GCC unroll 64
+		for (int v = 0; v < TILE; v++) {
+			roofline_vec bv;
+			memcpy(&bv, b + j + v * ROOFLINE_LANES, sizeof(bv));
+			memcpy(&cv[v], c + j + v * ROOFLINE_LANES, sizeof(bv));
+			#pragma GCC unroll 64
+			for (int i = 0; i < IND; i++)
+				t[i][v] = bv;
+		}
+		#pragma GCC unroll 2
+		for (int d = 0; d < DEP; d++)
+			#pragma GCC unroll 64
+			for (int i = 0; i < IND; i++)
+				#pragma GCC unroll 64
+				for (int v = 0; v < TILE; v++)
+					t[i][v] = t[i][v]*s[i] + cv[v];
+		#pragma GCC unroll 64
+		for (int v = 0; v < TILE; v++) {
+			roofline_vec sum = t[0][v];
+			#pragma GCC unroll 64
+			for (int i = 1; i < IND; i++)
+				sum += t[i][v];
+			memcpy(a + j + v * ROOFLINE_LANES, &sum, sizeof(sum));
+		}
+	}
+	for (; j < n; j++)
+		a[j] = roofline_element<DEP, IND>(s, b[j], c[j]);
+}
+
+struct RooflineKernel {
+	int	dependent;
+	int	independent;
+	void	(*fn)(STREAM_TYPE *a, const STREAM_TYPE *b, const STREAM_TYPE *c, ssize_t n);
+};
+
+# define ROOFLINE_ENTRY(d, i)	{ d, i, roofline_kernel<d, i> },
+
+static const RooflineKernel roofline_kernels[] = {
+	ROOFLINE_POINTS(ROOFLINE_ENTRY)
+};
+
+# define NUM_ROOFLINE_KERNELS	(sizeof(roofline_kernels)/sizeof(roofline_kernels[0]))
+
+static int roofline_check(const RooflineKernel &k, const STREAM_TYPE *a,
+                          const STREAM_TYPE *b, const STREAM_TYPE *c, ssize_t n) {
+	ssize_t step = n > ROOFLINE_CHECKS ? n / ROOFLINE_CHECKS : 1;
+	int err = 0;
+	for (ssize_t j = 0; j < n; j += step) {
+		STREAM_TYPE ref;
+		k.fn(&ref, b + j, c + j, 1);
+		if (fabs(a[j] - ref) > ROOFLINE_EPSILON * fabs(ref))
+			err++;
+	}
+	return err;
+}
+
+void roofline_run(STREAM_TYPE *a, const STREAM_TYPE *b, const STREAM_TYPE *c,
+                  ssize_t n, int ntimes, int32_t lproc_id,
+                  std::vector<RooflinePoint> *points) {
+	points->clear();
+	for (size_t p = 0; p < NUM_ROOFLINE_KERNELS; p++) {
+		const RooflineKernel &k = roofline_kernels[p];
+		RooflinePoint pt;
+		ssize_t roi_chunk = 0;
+		pt.dependent = k.dependent;
+		pt.independent = k.independent;
+		pt.flops = 2.0 * k.dependent * k.independent + (k.independent - 1);
+		pt.bytes = 3.0 * sizeof(STREAM_TYPE);
+		pt.times.resize(ntimes);
+
+		ROICounter start(lproc_id);
+		ROICounter stop(lproc_id);
+		start.start_roi();
+		for (int t = 0; t < ntimes; t++) {
+			pt.times[t] = timer_now();
+			#pragma omp parallel
+			{
+				ssize_t lo, hi;
+				kernel_chunk(n, &lo, &hi);
+				k.fn(a+lo, b+lo, c+lo, hi-lo);
+				#ifdef _OPENMP
+				if (omp_get_thread_num() == 0)
+				#endif
+					roi_chunk = hi - lo;
+			}
+			pt.times[t] = timer_now() - pt.times[t];
+		}
+		stop.stop_roi();
+		pt.roi = (stop - start).metrics();
+		pt.roi_elements = (double)roi_chunk * ntimes;
+		pt.stats = stats_summarize(&pt.times[1], ntimes - 1);
+		pt.validation_errors = roofline_check(k, a, b, c, n);
+		points->push_back(pt);
+	}
+}
+
+/*
+ * Both roofs are attained maxima, so no point lies above the model. The
+ * compute roof is the plateau: the best GFLOP/s of any point. Points, by
+ * ascending intensity, that stay below ROOFLINE_PLATEAU of it are memory
+ * bound and their best GB/s is the bandwidth roof; if even the lowest
+ * intensity reaches the plateau, that point alone stands in.
+ */
+RooflineFit roofline_fit(const std::vector<RooflinePoint> &points, double n) {
+	RooflineFit fit;
+	size_t np = points.size();
+	std::vector<size_t> order(np);
+	for (size_t i = 0; i < np; i++)
+		order[i] = i;
+	for (size_t i = 1; i < np; i++)
+		for (size_t j = i; j > 0 && points[order[j]].intensity() < points[order[j-1]].intensity(); j--) {
+			size_t tmp = order[j]; order[j] = order[j-1]; order[j-1] = tmp;
+		}
+
+	fit.peak_gflops = 0.0;
+	fit.bandwidth_gbps = 0.0;
+	for (size_t i = 0; i < np; i++)
+		fit.peak_gflops = fmax(fit.peak_gflops, points[i].gflops(n));
+	fit.memory_points = 0;
+	while (fit.memory_points < np &&
+	       points[order[fit.memory_points]].gflops(n) < ROOFLINE_PLATEAU * fit.peak_gflops)
+		fit.memory_points++;
+	size_t m = fit.memory_points > 0 ? fit.memory_points : 1;
+	for (size_t i = 0; i < m && i < np; i++)
+		fit.bandwidth_gbps = fmax(fit.bandwidth_gbps, points[order[i]].gbps(n));
+	fit.ridge = fit.peak_gflops / fit.bandwidth_gbps;
+	return fit;
+}
+
+void roofline_print(FILE *fp, const std::vector<RooflinePoint> &points,
+                    const RooflineFit &fit, double n) {
+	fprintf(fp, "Roofline: Triad stream, %.0f bytes/element, median of %zu timed iterations\n",
+		points.empty() ? 0.0 : points[0].bytes, points.empty() ? (size_t)0 : points[0].stats.n);
+	fprintf(fp, "Dep  Ind   FLOP/elem  FLOP/byte    GFLOP/s       GB/s   FLOP/cycle\n");
+	for (size_t i = 0; i < points.size(); i++) {
+		const RooflinePoint &pt = points[i];
+		fprintf(fp, "%3d  %3d  %10.0f  %9.3f  %9.3f  %9.3f", pt.dependent, pt.independent,
+			pt.flops, pt.intensity(), pt.gflops(n), pt.gbps(n));
+		/* ROI thread only: its share of the FLOPs over its core cycles */
+		if (pt.roi.cpu_cycles > 0)
+			fprintf(fp, "  %11.3f", pt.flops * pt.roi_elements / pt.roi.cpu_cycles);
+		else
+			fprintf(fp, "  %11s", "n/a");
+		fprintf(fp, "%s\n", pt.validation_errors ? "  (failed validation)" : "");
+	}
+	fprintf(fp, "Fit: bandwidth roof %.3f GB/s (%zu points), compute roof %.3f GFLOP/s,"
+		" ridge at %.3f FLOP/byte\n",
+		fit.bandwidth_gbps, fit.memory_points, fit.peak_gflops, fit.ridge);
+}
+
+int roofline_write_json(const char *path, const RunConfig &cfg, const std::vector<RooflinePoint> &points,
+                        const RooflineFit &fit, double n) {
+	FILE *fp = result_open(path);
+	if (fp == NULL)
+		return -1;
+	fprintf(fp, "{\n  \"schema\": \"%s\",\n", ROOFLINE_SCHEMA);
+	write_config_json(fp, cfg);
+	fprintf(fp, ",\n  \"num_elements\": %.0f,\n  \"points\": [\n", n);
+	for (size_t i = 0; i < points.size(); i++) {
+		const RooflinePoint &pt = points[i];
+		fprintf(fp, "    {\"dependent\": %d, \"independent\": %d, \"flops_per_element\": %.0f,"
+			" \"bytes_per_element\": %.0f, \"intensity\": %.6g, \"median_s\": %.9g,"
+			" \"gflops\": %.6g, \"gbps\": %.6g, \"roi_cpu_cycles\": %llu,"
+			" \"roi_elements\": %.0f, \"validation_errors\": %d}%s\n",
+			pt.dependent, pt.independent, pt.flops, pt.bytes, pt.intensity(),
+			pt.stats.median, pt.gflops(n), pt.gbps(n),
+			(unsigned long long)pt.roi.cpu_cycles, pt.roi_elements,
+			pt.validation_errors, i + 1 < points.size() ? "," : "");
+	}
+	fprintf(fp, "  ],\n  \"fit\": {\"bandwidth_gbps\": %.6g, \"peak_gflops\": %.6g,"
+		" \"ridge\": %.6g, \"memory_points\": %zu}\n}\n",
+		fit.bandwidth_gbps, fit.peak_gflops, fit.ridge, fit.memory_points);
+	return result_close(fp);
+}
+
+int roofline_write_csv(const char *path, const std::vector<RooflinePoint> &points,
+                       const RooflineFit &fit, double n) {
+	FILE *fp = result_open(path);
+	if (fp == NULL)
+		return -1;
+	fprintf(fp, "dependent,independent,flops_per_element,bytes_per_element,intensity,"
+		"median_s,gflops,gbps,roi_cpu_cycles,roi_elements,validation_passed,"
+		"fit_bandwidth_gbps,fit_peak_gflops,fit_ridge\n");
+	for (size_t i = 0; i < points.size(); i++) {
+		const RooflinePoint &pt = points[i];
+		fprintf(fp, "%d,%d,%.0f,%.0f,%.6g,%.9g,%.6g,%.6g,%llu,%.0f,%d,%.6g,%.6g,%.6g\n",
+			pt.dependent, pt.independent, pt.flops, pt.bytes, pt.intensity(),
+			pt.stats.median, pt.gflops(n), pt.gbps(n),
+			(unsigned long long)pt.roi.cpu_cycles, pt.roi_elements,
+			pt.validation_errors == 0,
+			fit.bandwidth_gbps, fit.peak_gflops, fit.ridge);
+	}
+	return result_close(fp);
+}
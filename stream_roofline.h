@@ -0,0 +1,74 @@
+/*-----------------------------------------------------------------------*/
+/* Roofline mode: arithmetic-intensity sweep over the Triad stream.      */
+/*                                                                       */
+/* Every point keeps the Triad access pattern (read b and c, write a)    */
+/* but computes each a[j] with 'independent' chains of 'dependent'       */
+/* FMAs, so the bytes per element stay fixed while the FLOPs grow. The   */
+/* points are instantiated at compile time from ROOFLINE_POINTS; the     */
+/* measured GFLOP/s and GB/s are then fitted to min(peak, AI*bandwidth). */
+/*-----------------------------------------------------------------------*/
+#ifndef STREAM_ROOFLINE_H
+#define STREAM_ROOFLINE_H
+
+# include <stdio.h>
+# include <sys/types.h>
+# include <vector>
+# include "stream_kernels.h"
+# include "stream_stats.h"
+# include "roi_counter.h"
+# include "stream_output.h"
+
+/*
+ * The (dependent, independent) FMA counts per element, as an X-macro.
+ * Override on the compile line, e.g.
+ *   -D'ROOFLINE_POINTS(P)=P(1,1) P(4,4) P(16,16)'
+ */
+#ifndef ROOFLINE_POINTS
+# define ROOFLINE_POINTS(P) \
+	P(1,1) P(1,2) P(1,4) P(1,8) P(2,8) P(4,8) P(8,8) P(16,8) P(32,8) P(64,8)
+#endif
+
+struct RooflinePoint {
+	int		dependent;	/* FMAs in each chain */
+	int		independent;	/* chains per element */
+	double		flops;		/* per element */
+	double		bytes;		/* per element, STREAM counting */
+	std::vector<double> times;	/* every iteration; times[0] is warm-up */
+	SampleStats	stats;		/* over times[1..] */
+	RoiMetrics	roi;		/* ROI thread, whole point */
+	double		roi_elements;	/* elements the ROI thread processed */
+	int		validation_errors;
+
+	double intensity() const { return flops / bytes; }
+	double gflops(double n) const { return 1.0E-09 * flops * n / stats.median; }
+	double gbps(double n) const { return 1.0E-09 * bytes * n / stats.median; }
+};
+
+/* Tag of the JSON document, next to the STREAM result's RESULT_SCHEMA */
+# define ROOFLINE_SCHEMA	"band_stream_roofline/1"
+
+/* Two-segment model: attained = min(peak_gflops, AI * bandwidth_gbps) */
+struct RooflineFit {
+	double	peak_gflops;
+	double	bandwidth_gbps;
+	double	ridge;		/* FLOP/byte where the segments meet */
+	size_t	memory_points;	/* points (by ascending AI) on the bandwidth roof */
+};
+
+/* Run every compiled-in point for ntimes iterations over a = f(b, c) */
+void roofline_run(STREAM_TYPE *a, const STREAM_TYPE *b, const STREAM_TYPE *c,
+                  ssize_t n, int ntimes, int32_t lproc_id,
+                  std::vector<RooflinePoint> *points);
+
+RooflineFit roofline_fit(const std::vector<RooflinePoint> &points, double n);
+
+void roofline_print(FILE *fp, const std::vector<RooflinePoint> &points,
+                    const RooflineFit &fit, double n);
+
+/* Write to 'path' ("-" for stdout); 0 on success. The JSON carries 'cfg' like a STREAM result. */
+int roofline_write_json(const char *path, const RunConfig &cfg, const std::vector<RooflinePoint> &points,
+                        const RooflineFit &fit, double n);
+int roofline_write_csv(const char *path, const std::vector<RooflinePoint> &points,
+                       const RooflineFit &fit, double n);
+
+#endif /* STREAM_ROOFLINE_H */
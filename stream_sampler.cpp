@@ -0,0 +1,164 @@
+/*-----------------------------------------------------------------------*/
+/* Bandwidth time-series sampling during the timed loop.                 */
+/*-----------------------------------------------------------------------*/
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
+# include <algorithm>
+# include <pthread.h>
+# include <sched.h>
+# include <stdlib.h>
+# include <string.h>
+# include <time.h>
+# include "stream_sampler.h"
+# include "stream_output.h"
+# include "stream_stats.h"
+# include "stream_threads.h"
+# include "stream_timer.h"
+
+Sampler sampler;
+
+static pthread_t monitor_thread;
+static int monitor_running;
+static double monitor_t0;
+
+static uint64_t sampler_total() {
+	uint64_t sum = 0;
+	for (int i = 0; i < sampler.nslots; i++)
+		sum += __atomic_load_n(&sampler.slots[i].bytes, __ATOMIC_RELAXED);
+	return sum;
+}
+
+static void *monitor_main(void *) {
+	struct timespec next;
+	clock_gettime(CLOCK_MONOTONIC, &next);
+	while (__atomic_load_n(&monitor_running, __ATOMIC_ACQUIRE)) {
+		next.tv_nsec += sampler.interval_us * 1000;
+		while (next.tv_nsec >= 1000000000L) {
+			next.tv_nsec -= 1000000000L;
+			next.tv_sec++;
+		}
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+		if (sampler.samples.size() == sampler.samples.capacity())
+			continue;
+		BandwidthSample s;
+		s.time_s = timer_now() - monitor_t0;
+		s.bytes = sampler_total();
+		s.phase = __atomic_load_n(&sampler.phase, __ATOMIC_RELAXED);
+		sampler.samples.push_back(s);
+	}
+	return NULL;
+}
+
+/*
+ * Highest-numbered CPU in our affinity mask, if the team of 'threads'
+ * leaves one over; OpenMP fills from the bottom. -1 when every CPU runs
+ * a worker: pinned there, the monitor would steal from a timed thread.
+ */
+static int free_cpu(int threads) {
+	cpu_set_t set;
+	if (sched_getaffinity(0, sizeof(set), &set) != 0 || CPU_COUNT(&set) <= threads)
+		return -1;
+	for (int c = CPU_SETSIZE - 1; c >= 0; c--)
+		if (CPU_ISSET(c, &set))
+			return c;
+	return -1;
+}
+
+int sampler_start(int cpu, long interval_us, int threads) {
+	void *mem;
+	if (posix_memalign(&mem, CACHE_LINE_BYTES, threads * sizeof(ProgressSlot)) != 0)
+		return -1;
+	memset(mem, 0, threads * sizeof(ProgressSlot));
+	sampler.slots = (ProgressSlot *)mem;
+	sampler.nslots = threads;
+	sampler.interval_us = interval_us;
+	sampler.cpu = cpu >= 0 ? cpu : free_cpu(threads);
+	sampler.samples.clear();
+	sampler.samples.reserve(SAMPLER_MAX_SAMPLES);
+	sampler.phase = -1;
+
+	if (sampler.cpu < 0)
+		fprintf(stderr, "WARNING: all CPUs run OpenMP workers; the bandwidth monitor runs unpinned\n");
+	monitor_t0 = timer_now();
+	monitor_running = 1;
+	if (thread_start_pinned(&monitor_thread, sampler.cpu, monitor_main, NULL) != 0) {
+		free(sampler.slots);
+		sampler.slots = NULL;
+		return -1;
+	}
+	sampler.active = true;
+	return 0;
+}
+
+void sampler_stop() {
+	if (!sampler.active)
+		return;
+	__atomic_store_n(&monitor_running, 0, __ATOMIC_RELEASE);
+	pthread_join(monitor_thread, NULL);
+	sampler.active = false;
+	free(sampler.slots);
+	sampler.slots = NULL;
+	sampler.nslots = 0;
+}
+
+static double interval_mbps(size_t i) {
+	const BandwidthSample &s = sampler.samples[i];
+	const BandwidthSample &p = sampler.samples[i - 1];
+	return 1.0E-06 * (s.bytes - p.bytes) / (s.time_s - p.time_s);
+}
+
+/*
+ * Only intervals that lie entirely inside one kernel count towards the
+ * summary, so the gaps between kernels do not read as dips.
+ */
+void sampler_print(FILE *fp, const char *const *kernel_names, double dip_fraction) {
+	std::vector<double> bw;
+	std::vector<size_t> at;
+	for (size_t i = 1; i < sampler.samples.size(); i++) {
+		if (sampler.samples[i].phase < 0 || sampler.samples[i].phase != sampler.samples[i-1].phase)
+			continue;
+		bw.push_back(interval_mbps(i));
+		at.push_back(i);
+	}
+	fprintf(fp, "Bandwidth samples: %zu every %ld us on CPU %d%s\n", sampler.samples.size(),
+		sampler.interval_us, sampler.cpu,
+		sampler.samples.size() == SAMPLER_MAX_SAMPLES ? " (buffer full, trace truncated)" : "");
+	if (bw.empty()) {
+		fprintf(fp, "No sampling interval fell inside a kernel; lower --sample-interval\n");
+		return;
+	}
+	std::vector<double> sorted(bw);
+	std::sort(sorted.begin(), sorted.end());
+	double median = stats_percentile_sorted(&sorted[0], sorted.size(), 0.5);
+	fprintf(fp, "Interval MB/s: min %.1f  p10 %.1f  median %.1f  p90 %.1f  max %.1f\n",
+		sorted[0], stats_percentile_sorted(&sorted[0], sorted.size(), 0.10), median,
+		stats_percentile_sorted(&sorted[0], sorted.size(), 0.90), sorted.back());
+	size_t dips = 0;
+	for (size_t i = 0; i < bw.size(); i++) {
+		if (bw[i] >= dip_fraction * median)
+			continue;
+		if (dips++ < 10) {
+			const BandwidthSample &s = sampler.samples[at[i]];
+			fprintf(fp, "    dip at %10.6f s: %10.1f MB/s during %s\n",
+				s.time_s, bw[i], kernel_names[s.phase]);
+		}
+	}
+	fprintf(fp, "Intervals below %.0f%% of the median: %zu of %zu\n",
+		100.0 * dip_fraction, dips, bw.size());
+}
+
+int sampler_write_trace(const char *path, const char *const *kernel_names) {
+	FILE *fp = result_open(path);
+	if (fp == NULL)
+		return -1;
+	fprintf(fp, "sample,time_s,bytes,interval_MBps,kernel\n");
+	for (size_t i = 0; i < sampler.samples.size(); i++) {
+		const BandwidthSample &s = sampler.samples[i];
+		fprintf(fp, "%zu,%.9f,%llu,", i, s.time_s, (unsigned long long)s.bytes);
+		if (i > 0)
+			fprintf(fp, "%.3f", interval_mbps(i));
+		fprintf(fp, ",%s\n", s.phase >= 0 ? kernel_names[s.phase] : "");
+	}
+	return result_close(fp);
+}
@@ -0,0 +1,123 @@
+/*-----------------------------------------------------------------------*/
+/* Bandwidth time-series sampling during the timed loop.                 */
+/*                                                                       */
+/* Worker threads publish the bytes they have completed in per-thread,   */
+/* cache-line padded progress counters. A monitor thread, pinned to a   */
+/* CPU outside the OpenMP team where there is one, wakes at a fixed      */
+/* interval, sums the counters and records a (time, bytes, kernel)       */
+/* sample, so throttling, DVFS ramps and periodic interference show up   */
+/* as dips in the bandwidth-over-time trace.                             */
+/*                                                                       */
+/* While sampling, kernels run their chunk in SAMPLER_SLICE_BYTES slices */
+/* and publish after every slice; otherwise the loops are unchanged.     */
+/*-----------------------------------------------------------------------*/
+#ifndef STREAM_SAMPLER_H
+#define STREAM_SAMPLER_H
+
+# include <stdio.h>
+# include <stdint.h>
+# include <sys/types.h>
+# include <vector>
+# include "stream_kernels.h"
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
+/* Default --sample-interval, in microseconds */
+#ifndef SAMPLER_INTERVAL_US
+#   define SAMPLER_INTERVAL_US	1000
+#endif
+
+/* Bytes of one array a worker processes between two progress updates */
+#ifndef SAMPLER_SLICE_BYTES
+#   define SAMPLER_SLICE_BYTES	(64 * 1024)
+#endif
+
+struct BandwidthSample {
+	double		time_s;		/* since sampler_start() */
+	uint64_t	bytes;		/* completed by all threads so far */
+	int		phase;		/* kernel running at the sample, -1 if none */
+};
+
+/* Samples kept per run; the monitor stops recording when they run out */
+#ifndef SAMPLER_MAX_SAMPLES
+#   define SAMPLER_MAX_SAMPLES	(1 << 18)
+#endif
+
+/* One counter per worker, alone on its cache line */
+struct ProgressSlot {
+	uint64_t	bytes;
+	char		pad[CACHE_LINE_BYTES - sizeof(uint64_t)];
+};
+
+struct Sampler {
+	bool		active;
+	int		cpu;		/* monitor CPU, -1 if left unpinned */
+	long		interval_us;
+	ProgressSlot	*slots;		/* one per OpenMP thread, line aligned */
+	int		nslots;
+	std::vector<BandwidthSample> samples;
+	int		phase;
+
+	Sampler() : active(false), cpu(-1), interval_us(SAMPLER_INTERVAL_US), slots(NULL), nslots(0), phase(-1) {}
+};
+
+extern Sampler sampler;
+
+/*
+ * Start the monitor thread on 'cpu'. With -1 it takes the last CPU this
+ * process may run on if the 'threads' workers leave one free, and runs
+ * unpinned otherwise. SAMPLER_MAX_SAMPLES are reserved up front, so the monitor
+ * never allocates while the kernels run. Returns 0 on success.
+ */
+int sampler_start(int cpu, long interval_us, int threads);
+
+/* Stop and join the monitor; the samples stay in 'sampler' */
+void sampler_stop();
+
+/* Tag the following samples with kernel index 'k' (-1 between kernels) */
+static inline void sampler_phase(int k) {
+	__atomic_store_n(&sampler.phase, k, __ATOMIC_RELAXED);
+}
+
+/* Elements of elem_bytes each in [s, hi) to process before the next progress update */
+static inline ssize_t sampler_slice(ssize_t s, ssize_t hi, size_t elem_bytes) {
+	const ssize_t slice = SAMPLER_SLICE_BYTES / elem_bytes;
+	return (!sampler.active || hi - s < slice) ? hi - s : slice;
+}
+
+static inline void sampler_progress(uint64_t bytes) {
+	if (!sampler.active)
+		return;
+	#ifdef _OPENMP
+	ProgressSlot &p = sampler.slots[omp_get_thread_num()];
+	#else
+	ProgressSlot &p = sampler.slots[0];
+	#endif
+	/* Single writer per slot: a relaxed store is enough for the monitor */
+	__atomic_store_n(&p.bytes, p.bytes + bytes, __ATOMIC_RELAXED);
+}
+
+/*
+ * Run 'body' over [lo, hi) in sampler slices of s, m elements of
+ * 'elem_bytes' each, crediting 'traffic' bytes per element after each slice.
+ */
+# define SAMPLED_CHUNK(lo, hi, elem_bytes, traffic, body)                  \
+	for (ssize_t s = (lo), m; s < (hi); s += m) {                         \
+		m = sampler_slice(s, (hi), (elem_bytes));                         \
+		body;                                                             \
+		sampler_progress((traffic) * (uint64_t)m);                        \
+	}
+
+/* Intervals below this fraction of the median are reported as dips */
+#ifndef SAMPLER_DIP_FRACTION
+#   define SAMPLER_DIP_FRACTION	0.8
+#endif
+
+/* Interval bandwidth summary and dips below 'dip_fraction' of the median */
+void sampler_print(FILE *fp, const char *const *kernel_names, double dip_fraction);
+
+/* One row per sample; '-' for stdout. 0 on success */
+int sampler_write_trace(const char *path, const char *const *kernel_names);
+
+#endif /* STREAM_SAMPLER_H */
@@ -0,0 +1,150 @@
+/*-----------------------------------------------------------------------*/
+/* Per-iteration sample statistics for the STREAM kernels.               */
+/*-----------------------------------------------------------------------*/
+# include <math.h>
+# include <algorithm>
+# include "stream_stats.h"
+
+/* splitmix64: small, fast and good enough for bootstrap index draws */
+static inline uint64_t stats_next_rand(uint64_t *state) {
+	uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+double stats_percentile_sorted(const double *sorted, size_t n, double q) {
+	if (n == 0)
+		return NAN;
+	if (q <= 0.0)
+		return sorted[0];
+	if (q >= 1.0)
+		return sorted[n-1];
+	double pos  = q * (double)(n - 1);
+	size_t lo   = (size_t)pos;
+	double frac = pos - (double)lo;
+	if (lo + 1 >= n)
+		return sorted[n-1];
+	return sorted[lo] + frac * (sorted[lo+1] - sorted[lo]);
+}
+
+double stats_median(const double *samples, size_t n) {
+	std::vector<double> tmp(samples, samples + n);
+	std::sort(tmp.begin(), tmp.end());
+	return stats_percentile_sorted(tmp.data(), n, 0.5);
+}
+
+SampleStats stats_summarize(const double *samples, size_t n,
+                            double ci_level, unsigned resamples,
+                            uint64_t seed) {
+	SampleStats s;
+	s.n          = n;
+	s.ci_level   = ci_level;
+	s.n_outliers = 0;
+	s.outlier.assign(n, false);
+	if (n == 0) {
+		s.min = s.mean = s.median = s.p90 = s.p99 = s.max = NAN;
+		s.stddev = s.mad = s.ci_lo = s.ci_hi = NAN;
+		return s;
+	}
+
+	std::vector<double> sorted(samples, samples + n);
+	std::sort(sorted.begin(), sorted.end());
+
+	double sum = 0.0;
+	for (size_t i = 0; i < n; i++)
+		sum += samples[i];
+	s.mean = sum / (double)n;
+
+	double var = 0.0;
+	for (size_t i = 0; i < n; i++)
+		var += (samples[i] - s.mean) * (samples[i] - s.mean);
+	s.stddev = (n > 1) ? sqrt(var / (double)(n - 1)) : 0.0;
+
+	s.min    = sorted[0];
+	s.max    = sorted[n-1];
+	s.median = stats_percentile_sorted(sorted.data(), n, 0.50);
+	s.p90    = stats_percentile_sorted(sorted.data(), n, 0.90);
+	s.p99    = stats_percentile_sorted(sorted.data(), n, 0.99);
+
+	/* MAD and modified z-score outliers */
+	std::vector<double> dev(n);
+	for (size_t i = 0; i < n; i++)
+		dev[i] = fabs(samples[i] - s.median);
+	s.mad = stats_median(dev.data(), n);
+	/* With a coarse timer MAD can be zero; fall back to the mean absolute deviation */
+	double scale = 0.0;
+	if (s.mad > 0.0) {
+		scale = s.mad / 0.6745;
+	} else {
+		double meanad = 0.0;
+		for (size_t i = 0; i < n; i++)
+			meanad += dev[i];
+		scale = 1.253314 * meanad / (double)n;
+	}
+	for (size_t i = 0; i < n; i++) {
+		bool flag = scale > 0.0 && dev[i] / scale > STATS_OUTLIER_Z;
+		s.outlier[i] = flag;
+		if (flag)
+			s.n_outliers++;
+	}
+
+	/* Percentile bootstrap on the median */
+	if (n < 2 || resamples == 0) {
+		s.ci_lo = s.ci_hi = s.median;
+		return s;
+	}
+	uint64_t state = seed;
+	std::vector<double> medians(resamples);
+	std::vector<double> draw(n);
+	for (unsigned r = 0; r < resamples; r++) {
+		for (size_t i = 0; i < n; i++)
+			draw[i] = samples[stats_next_rand(&state) % n];
+		std::sort(draw.begin(), draw.end());
+		medians[r] = stats_percentile_sorted(draw.data(), n, 0.5);
+	}
+	std::sort(medians.begin(), medians.end());
+	double alpha = (1.0 - ci_level) / 2.0;
+	s.ci_lo = stats_percentile_sorted(medians.data(), resamples, alpha);
+	s.ci_hi = stats_percentile_sorted(medians.data(), resamples, 1.0 - alpha);
+	return s;
+}
+
+double stats_mann_whitney_less(const double *x, size_t nx,
+                               const double *y, size_t ny) {
+	if (nx == 0 || ny == 0)
+		return NAN;
+
+	/* Rank the pooled samples, averaging ranks over ties */
+	size_t n = nx + ny;
+	std::vector<std::pair<double, size_t> > pool(n);
+	for (size_t i = 0; i < nx; i++)
+		pool[i] = std::make_pair(x[i], i);
+	for (size_t i = 0; i < ny; i++)
+		pool[nx + i] = std::make_pair(y[i], nx + i);
+	std::sort(pool.begin(), pool.end());
+
+	double rank_sum_x = 0.0;
+	double tie_term = 0.0;
+	for (size_t i = 0; i < n; ) {
+		size_t k = i;
+		while (k + 1 < n && pool[k + 1].first == pool[i].first)
+			k++;
+		double rank = 0.5 * (double)(i + k) + 1.0;
+		double t = (double)(k - i + 1);
+		tie_term += t * t * t - t;
+		for (size_t m = i; m <= k; m++)
+			if (pool[m].second < nx)
+				rank_sum_x += rank;
+		i = k + 1;
+	}
+
+	double dnx = (double)nx, dny = (double)ny, dn = (double)n;
+	double u  = rank_sum_x - dnx * (dnx + 1.0) / 2.0;
+	double mu = dnx * dny / 2.0;
+	double var = dnx * dny / 12.0 * ((dn + 1.0) - tie_term / (dn * (dn - 1.0)));
+	if (var <= 0.0)
+		return 1.0;	/* every sample tied: no evidence either way */
+	double z = (u - mu + 0.5) / sqrt(var);
+	return 0.5 * erfc(-z / sqrt(2.0));
+}
@@ -0,0 +1,67 @@
+/*-----------------------------------------------------------------------*/
+/* Per-iteration sample statistics for the STREAM kernels.               */
+/*                                                                       */
+/* STREAM classically reports the best of NTIMES-1 iterations. These     */
+/* helpers summarise the full distribution instead: order statistics,    */
+/* a bootstrap confidence interval on the median and MAD-based outlier   */
+/* flagging (modified z-score, Iglewicz & Hoaglin).                      */
+/*-----------------------------------------------------------------------*/
+#ifndef STREAM_STATS_H
+#define STREAM_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/* Modified z-score above which a sample is flagged as an outlier */
+#ifndef STATS_OUTLIER_Z
+#   define STATS_OUTLIER_Z	3.5
+#endif
+
+/* Number of bootstrap resamples used for the confidence interval */
+#ifndef STATS_BOOTSTRAP_RESAMPLES
+#   define STATS_BOOTSTRAP_RESAMPLES	2000
+#endif
+
+struct SampleStats {
+	size_t	n;
+	double	min;
+	double	mean;
+	double	median;
+	double	p90;
+	double	p99;
+	double	max;
+	double	stddev;
+	double	mad;		/* median absolute deviation (unscaled) */
+	double	ci_level;	/* e.g. 0.95 */
+	double	ci_lo;		/* bootstrap CI on the median */
+	double	ci_hi;
+	size_t	n_outliers;
+	std::vector<bool> outlier;	/* parallel to the input samples */
+};
+
+/* Linear-interpolated percentile (q in [0,1]) of an ascending-sorted array */
+double stats_percentile_sorted(const double *sorted, size_t n, double q);
+
+/* Median of an unsorted array (the input is not modified) */
+double stats_median(const double *samples, size_t n);
+
+/*
+ * Summarise n samples. The confidence interval on the median is a
+ * percentile bootstrap with 'resamples' draws from a generator seeded by
+ * 'seed', so repeated reports over the same samples are identical.
+ */
+SampleStats stats_summarize(const double *samples, size_t n,
+                            double ci_level = 0.95,
+                            unsigned resamples = STATS_BOOTSTRAP_RESAMPLES,
+                            uint64_t seed = 0x5eed5eedULL);
+
+/*
+ * One-sided Mann-Whitney U test (normal approximation with tie and
+ * continuity correction). Returns the p-value for the alternative that
+ * samples in x tend to be smaller than samples in y.
+ */
+double stats_mann_whitney_less(const double *x, size_t nx,
+                               const double *y, size_t ny);
+
+#endif /* STREAM_STATS_H */
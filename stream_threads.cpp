@@ -0,0 +1,41 @@
+/*-----------------------------------------------------------------------*/
+/* Pinned helper threads and a two-party start line.                     */
+/*-----------------------------------------------------------------------*/
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
+# include <pthread.h>
+# include <sched.h>
+# include "stream_threads.h"
+
+# define STARTLINE_ABORT	1000
+
+int thread_start_pinned(pthread_t *t, int cpu, void *(*fn)(void *), void *arg) {
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+	if (cpu >= 0) {
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(cpu, &set);
+		pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+	}
+	int rc = pthread_create(t, &attr, fn, arg);
+	pthread_attr_destroy(&attr);
+	return rc;
+}
+
+void startline_init(StartLine *s) {
+	s->ready = 0;
+}
+
+bool startline_wait(StartLine *s) {
+	__atomic_add_fetch(&s->ready, 1, __ATOMIC_ACQ_REL);
+	int n;
+	while ((n = __atomic_load_n(&s->ready, __ATOMIC_ACQUIRE)) < 2)
+		;
+	return n == 2;
+}
+
+void startline_abort(StartLine *s) {
+	__atomic_add_fetch(&s->ready, STARTLINE_ABORT, __ATOMIC_ACQ_REL);
+}
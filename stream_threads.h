@@ -0,0 +1,30 @@
+/*-----------------------------------------------------------------------*/
+/* Pinned helper threads and a two-party start line.                     */
+/*                                                                       */
+/* The ping-pong and ring pairs, the interference aggressors and the     */
+/* bandwidth monitor run on plain pthreads pinned to one CPU, outside    */
+/* the OpenMP team. A pair's two threads meet at a StartLine so neither  */
+/* starts timing before the other is running on its CPU; if the second   */
+/* thread cannot be started, the first is released with a failure.       */
+/*-----------------------------------------------------------------------*/
+#ifndef STREAM_THREADS_H
+#define STREAM_THREADS_H
+
+# include <pthread.h>
+
+/* Start fn(arg) on a thread pinned to 'cpu' (< 0: unpinned); pthread_create's result */
+int thread_start_pinned(pthread_t *t, int cpu, void *(*fn)(void *), void *arg);
+
+struct StartLine {
+	int	ready;		/* sides that have arrived; STARTLINE_ABORT added calls it off */
+};
+
+void startline_init(StartLine *s);
+
+/* Wait for the other side; false if the start was called off */
+bool startline_wait(StartLine *s);
+
+/* Release a side already waiting (its partner failed to start) */
+void startline_abort(StartLine *s);
+
+#endif /* STREAM_THREADS_H */
@@ -0,0 +1,170 @@
+/*-----------------------------------------------------------------------*/
+/* Calibrated high-resolution timer for STREAM.                          */
+/*-----------------------------------------------------------------------*/
+# include <stdio.h>
+# include <string.h>
+# include <algorithm>
+# include "stream_timer.h"
+#if defined(__amd64__)
+# include <cpuid.h>
+#endif
+
+TimerInfo timer_info = { TIMER_CLOCK, "clock_gettime", 1.0e9, 0.0, 0.0, true, NULL };
+
+static const struct {
+	const char	*name;
+	TimerSource	source;
+} timer_names[] = {
+	{"auto",    TIMER_AUTO},
+	{"clock",   TIMER_CLOCK},
+	{"tsc",     TIMER_TSC},
+	{"cntvct",  TIMER_CNTVCT},
+	{"rdtime",  TIMER_RDTIME},
+	{"rdcycle", TIMER_RDCYCLE},
+};
+
+bool timer_parse_source(const char *name, TimerSource *out) {
+	for (size_t i = 0; i < sizeof(timer_names)/sizeof(timer_names[0]); i++) {
+		if (strcmp(name, timer_names[i].name) == 0) {
+			*out = timer_names[i].source;
+			return true;
+		}
+	}
+	return false;
+}
+
+#if defined(__amd64__)
+/* CPUID.80000007H:EDX[8] - TSC runs at a constant rate in all ACPI states */
+static bool tsc_is_invariant() {
+	unsigned eax, ebx, ecx, edx;
+	if (__get_cpuid_max(0x80000000, NULL) < 0x80000007)
+		return false;
+	__cpuid(0x80000007, eax, ebx, ecx, edx);
+	return (edx >> 8) & 1;
+}
+#endif
+
+/*
+ * Ticks per second of the current source against CLOCK_MONOTONIC_RAW.
+ * Three short rounds; the median rejects a round hit by preemption.
+ */
+static double calibrate_hz() {
+	double hz[3];
+	for (int r = 0; r < 3; r++) {
+		uint64_t ns0 = timer_clock_ns();
+		uint64_t t0  = timer_ticks();
+		uint64_t ns1;
+		do {
+			ns1 = timer_clock_ns();
+		} while (ns1 - ns0 < (uint64_t)TIMER_CALIBRATION_MS * 1000000ULL);
+		uint64_t t1 = timer_ticks();
+		hz[r] = (double)(t1 - t0) * 1.0e9 / (double)(ns1 - ns0);
+	}
+	std::sort(hz, hz + 3);
+	return hz[1];
+}
+
+/* Smallest non-zero step between consecutive reads, and mean read cost */
+static void measure_resolution() {
+	const int reads = 1000;
+	uint64_t min_step = UINT64_MAX;
+	for (int i = 0; i < reads; i++) {
+		uint64_t t0 = timer_ticks();
+		uint64_t t1;
+		do {
+			t1 = timer_ticks();
+		} while (t1 == t0);
+		min_step = std::min(min_step, t1 - t0);
+	}
+	uint64_t start = timer_ticks();
+	for (int i = 0; i < reads; i++)
+		(void)timer_ticks();
+	uint64_t stop = timer_ticks();
+	timer_info.resolution_s = timer_seconds(min_step);
+	timer_info.overhead_s   = timer_seconds(stop - start) / reads;
+}
+
+static void use_clock(const char *note) {
+	timer_info.source    = TIMER_CLOCK;
+	timer_info.name      = "clock_gettime";
+	timer_info.hz        = 1.0e9;
+	timer_info.invariant = true;
+	timer_info.note      = note;
+}
+
+void timer_init(TimerSource requested) {
+	TimerSource src = requested;
+	use_clock(NULL);
+
+	if (src == TIMER_AUTO) {
+		#if defined(__amd64__)
+		src = TIMER_TSC;
+		#elif defined(__aarch64__)
+		src = TIMER_CNTVCT;
+		#elif defined(__riscv)
+		src = TIMER_RDTIME;
+		#else
+		src = TIMER_CLOCK;
+		#endif
+	}
+
+	switch (src) {
+	case TIMER_TSC:
+		#if defined(__amd64__)
+		if (!tsc_is_invariant()) {
+			use_clock("TSC is not invariant");
+			break;
+		}
+		timer_info.source    = TIMER_TSC;
+		timer_info.name      = "tsc";
+		timer_info.invariant = true;
+		timer_info.hz        = calibrate_hz();
+		#else
+		use_clock("rdtsc is not available on this target");
+		#endif
+		break;
+	case TIMER_CNTVCT:
+		#if defined(__aarch64__)
+		{
+			uint64_t frq;
+			__asm__ __volatile__("mrs %0, cntfrq_el0" : "=r"(frq));
+			timer_info.source    = TIMER_CNTVCT;
+			timer_info.name      = "cntvct_el0";
+			timer_info.invariant = true;
+			/* Firmware occasionally leaves CNTFRQ_EL0 unprogrammed */
+			timer_info.hz        = frq ? (double)frq : calibrate_hz();
+		}
+		#else
+		use_clock("cntvct_el0 is not available on this target");
+		#endif
+		break;
+	case TIMER_RDTIME:
+	case TIMER_RDCYCLE:
+		#if defined(__riscv)
+		timer_info.source    = src;
+		timer_info.name      = (src == TIMER_RDTIME) ? "rdtime" : "rdcycle";
+		/* rdcycle follows the core clock, which may scale */
+		timer_info.invariant = (src == TIMER_RDTIME);
+		timer_info.hz        = calibrate_hz();
+		#else
+		use_clock("rdtime/rdcycle are not available on this target");
+		#endif
+		break;
+	default:
+		break;
+	}
+
+	if (!(timer_info.hz > 0.0))
+		use_clock("counter did not advance during calibration");
+	measure_resolution();
+}
+
+void timer_report(FILE *fp) {
+	fprintf(fp, "Timer: %s%s, %.3f MHz, resolution %.1f ns, overhead %.1f ns per read\n",
+		timer_info.name, timer_info.invariant ? "" : " (not invariant)",
+		timer_info.hz * 1.0e-6,
+		timer_info.resolution_s * 1.0e9,
+		timer_info.overhead_s * 1.0e9);
+	if (timer_info.note != NULL)
+		fprintf(fp, "Timer: falling back to clock_gettime: %s\n", timer_info.note);
+}
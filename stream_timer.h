@@ -0,0 +1,115 @@
+/*-----------------------------------------------------------------------*/
+/* Calibrated high-resolution timer for STREAM.                          */
+/*                                                                       */
+/* Ticks come from the cheapest trustworthy counter on each build        */
+/* target and are converted to seconds with a frequency that is either   */
+/* architectural (CNTFRQ_EL0) or calibrated against CLOCK_MONOTONIC_RAW: */
+/*   AMD64      rdtsc, only if the TSC is invariant                       */
+/*   AARCH64    cntvct_el0                                               */
+/*   GEM5_RV64  rdtime (or rdcycle on request)                           */
+/* Anything else, or a counter that fails its checks, falls back to      */
+/* clock_gettime() in nanoseconds.                                       */
+/*-----------------------------------------------------------------------*/
+#ifndef STREAM_TIMER_H
+#define STREAM_TIMER_H
+
+# include <stdio.h>
+# include <stdint.h>
+# include <time.h>
+#if defined(__amd64__)
+# include <x86intrin.h>
+#endif
+
+/* How long each calibration round spins; simulated time is expensive */
+#ifndef TIMER_CALIBRATION_MS
+#ifdef GEM5_RV64
+#   define TIMER_CALIBRATION_MS	1
+#else
+#   define TIMER_CALIBRATION_MS	20
+#endif
+#endif
+
+enum TimerSource {
+	TIMER_AUTO = 0,
+	TIMER_CLOCK,	/* clock_gettime(CLOCK_MONOTONIC_RAW), ns */
+	TIMER_TSC,	/* x86 rdtsc */
+	TIMER_CNTVCT,	/* AArch64 virtual counter */
+	TIMER_RDTIME,	/* RISC-V rdtime */
+	TIMER_RDCYCLE	/* RISC-V rdcycle */
+};
+
+struct TimerInfo {
+	TimerSource	source;
+	const char	*name;
+	double		hz;		/* ticks per second */
+	double		resolution_s;	/* smallest observed non-zero step */
+	double		overhead_s;	/* average cost of one read */
+	bool		invariant;	/* rate independent of P/C-states */
+	const char	*note;		/* why a fallback happened, or NULL */
+};
+
+extern TimerInfo timer_info;
+
+/*
+ * Select and calibrate the timer. 'requested' forces a source; if that
+ * source is not available on this build or machine the clock_gettime
+ * fallback is used and timer_info.note says why.
+ */
+void timer_init(TimerSource requested = TIMER_AUTO);
+
+/* Parse a --timer argument; returns false on an unknown name */
+bool timer_parse_source(const char *name, TimerSource *out);
+
+/* Print source, frequency, resolution and overhead */
+void timer_report(FILE *fp);
+
+static inline uint64_t timer_clock_ns() {
+	struct timespec ts;
+	#ifdef CLOCK_MONOTONIC_RAW
+	clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+	#else
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	#endif
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint64_t timer_ticks() {
+	switch (timer_info.source) {
+	#if defined(__amd64__)
+	case TIMER_TSC:
+		return __rdtsc();
+	#endif
+	#if defined(__aarch64__)
+	case TIMER_CNTVCT: {
+		uint64_t v;
+		__asm__ __volatile__("isb; mrs %0, cntvct_el0" : "=r"(v) :: "memory");
+		return v;
+	}
+	#endif
+	#if defined(__riscv)
+	case TIMER_RDTIME: {
+		uint64_t v;
+		__asm__ __volatile__("rdtime %0" : "=r"(v));
+		return v;
+	}
+	case TIMER_RDCYCLE: {
+		uint64_t v;
+		__asm__ __volatile__("rdcycle %0" : "=r"(v));
+		return v;
+	}
+	#endif
+	default:
+		return timer_clock_ns();
+	}
+}
+
+static inline double timer_seconds(uint64_t ticks) {
+	return (double)ticks / timer_info.hz;
+}
+
+/* Seconds since an arbitrary epoch */
+static inline double timer_now() {
+	return timer_seconds(timer_ticks());
+}
+
+#endif /* STREAM_TIMER_H */
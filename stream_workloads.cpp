@@ -0,0 +1,172 @@
+/*-----------------------------------------------------------------------*/
+/* Production-representative kernels for the registry.                   */
+/*                                                                       */
+/*   rowdecode  fixed-width 16-byte records (id, quantity, flags, price  */
+/*              in cents) decoded into id, quantity and price columns;   */
+/*              deleted rows get quantity 0                              */
+/*   checksum   64-bit mixing checksum over a read-only buffer, summed   */
+/*              across threads (order independent)                       */
+/*-----------------------------------------------------------------------*/
+# include <stdint.h>
+# include <stdlib.h>
+# include <string.h>
+# include "stream_registry.h"
+
+static void *alloc_lines(size_t bytes) {
+	void *p;
+	return posix_memalign(&p, CACHE_LINE_BYTES, bytes > 0 ? bytes : 1) == 0 ? p : NULL;
+}
+
+static inline uint64_t mix(uint64_t x) {
+	x ^= x >> 31;
+	x *= 0x9e3779b97f4a7c15ULL;
+	return x ^ (x >> 29);
+}
+
+/* --- rowdecode --- */
+
+# define ROW_DELETED	0x1
+
+struct PackedRow {
+	uint32_t	id;
+	uint16_t	qty;
+	uint16_t	flags;
+	int64_t		price_cents;
+};
+
+struct RowDecode {
+	PackedRow	*rows;
+	uint32_t	*id;
+	uint32_t	*qty;
+	double		*price;
+};
+
+static inline void decode_row(const PackedRow &r, uint32_t *id, uint32_t *qty, double *price) {
+	*id = r.id;
+	*qty = (r.flags & ROW_DELETED) ? 0 : r.qty;
+	*price = r.price_cents * 0.01;
+}
+
+static int rowdecode_setup(KernelContext *ctx) {
+	ssize_t n = ctx->elements;
+	RowDecode *s = (RowDecode *)ctx->state;
+	if (s == NULL) {
+		s = (RowDecode *)calloc(1, sizeof(RowDecode));
+		if (s == NULL)
+			return -1;
+		ctx->state = s;
+		s->rows = (PackedRow *)alloc_lines(n * sizeof(PackedRow));
+		s->id = (uint32_t *)alloc_lines(n * sizeof(uint32_t));
+		s->qty = (uint32_t *)alloc_lines(n * sizeof(uint32_t));
+		s->price = (double *)alloc_lines(n * sizeof(double));
+		if (s->rows == NULL || s->id == NULL || s->qty == NULL || s->price == NULL)
+			return -1;
+	}
+	for (ssize_t i = 0; i < n; i++) {
+		uint64_t h = mix(i);
+		s->rows[i].id = (uint32_t)i;
+		s->rows[i].qty = (uint16_t)(h & 0x3ff);
+		s->rows[i].flags = (h >> 16) % 16 == 0 ? ROW_DELETED : 0;
+		s->rows[i].price_cents = (int64_t)((h >> 20) % 1000000);
+	}
+	memset(s->id, 0, n * sizeof(uint32_t));
+	memset(s->qty, 0, n * sizeof(uint32_t));
+	memset(s->price, 0, n * sizeof(double));
+	return 0;
+}
+
+static void rowdecode_body(const KernelContext &ctx, ssize_t lo, ssize_t hi) {
+	const RowDecode *s = (const RowDecode *)ctx.state;
+	const PackedRow *rows = s->rows;
+	uint32_t *id = s->id, *qty = s->qty;
+	double *price = s->price;
+	for (ssize_t i = lo; i < hi; i++)
+		decode_row(rows[i], &id[i], &qty[i], &price[i]);
+}
+
+static int rowdecode_verify(const KernelContext &ctx, int ntimes) {
+	const RowDecode *s = (const RowDecode *)ctx.state;
+	int errors = 0;
+	(void)ntimes;
+	for (ssize_t i = 0; i < ctx.elements; i++) {
+		uint32_t id, qty;
+		double price;
+		decode_row(s->rows[i], &id, &qty, &price);
+		errors += s->id[i] != id || s->qty[i] != qty || s->price[i] != price;
+	}
+	return errors;
+}
+
+static void rowdecode_teardown(KernelContext *ctx) {
+	RowDecode *s = (RowDecode *)ctx->state;
+	if (s == NULL)
+		return;
+	free(s->rows);
+	free(s->id);
+	free(s->qty);
+	free(s->price);
+	free(s);
+	ctx->state = NULL;
+}
+
+const StreamKernel stream_kernel_rowdecode = {
+	"rowdecode", "RowDecode", "16-byte records into id/quantity/price columns",
+	"row16", sizeof(PackedRow), sizeof(PackedRow), 2 * sizeof(uint32_t) + sizeof(double), false,
+	rowdecode_setup, rowdecode_body, rowdecode_verify, rowdecode_teardown
+};
+
+/* --- checksum --- */
+
+struct Checksum {
+	uint64_t	*words;
+	uint64_t	total;		/* over the runs since setup(), mod 2^64 */
+};
+
+static int checksum_setup(KernelContext *ctx) {
+	Checksum *s = (Checksum *)ctx->state;
+	if (s == NULL) {
+		s = (Checksum *)calloc(1, sizeof(Checksum));
+		if (s == NULL)
+			return -1;
+		ctx->state = s;
+		s->words = (uint64_t *)alloc_lines(ctx->elements * sizeof(uint64_t));
+		if (s->words == NULL)
+			return -1;
+	}
+	s->total = 0;
+	for (ssize_t i = 0; i < ctx->elements; i++)
+		s->words[i] = mix(i + 1);
+	return 0;
+}
+
+static void checksum_body(const KernelContext &ctx, ssize_t lo, ssize_t hi) {
+	Checksum *s = (Checksum *)ctx.state;
+	const uint64_t *w = s->words;
+	uint64_t sum = 0;
+	for (ssize_t i = lo; i < hi; i++)
+		sum += mix(w[i]);
+	__atomic_fetch_add(&s->total, sum, __ATOMIC_RELAXED);
+}
+
+static int checksum_verify(const KernelContext &ctx, int ntimes) {
+	const Checksum *s = (const Checksum *)ctx.state;
+	uint64_t sum = 0;
+	for (ssize_t i = 0; i < ctx.elements; i++)
+		sum += mix(s->words[i]);
+	return s->total != sum * (uint64_t)ntimes;
+}
+
+static void checksum_teardown(KernelContext *ctx) {
+	Checksum *s = (Checksum *)ctx->state;
+	if (s == NULL)
+		return;
+	free(s->words);
+	free(s);
+	ctx->state = NULL;
+}
+
+const StreamKernel stream_kernel_checksum = {
+	"checksum", "Checksum", "64-bit mixing checksum, reduced across threads",
+	"uint64", sizeof(uint64_t), sizeof(uint64_t), 0, false,
+	checksum_setup, checksum_body, checksum_verify, checksum_teardown
+};